@@ -1,12 +1,15 @@
 #include "devices/disk.h"
 #include <ctype.h>
 #include <debug.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/workqueue.h"
+#include "intrinsic.h"
 
 /* The code in this file is an interface to an ATA (IDE)
    controller.  It attempts to comply to [ATA-3]. */
@@ -48,6 +51,10 @@
 #define CMD_READ_SECTOR_RETRY 0x20      /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30     /* WRITE SECTOR with retries. */
 
+/* Longest wait for the interrupt that ends a command, in timer
+   ticks.  Matches the 30 seconds wait_while_busy() allows. */
+#define IRQ_TIMEOUT (30 * TIMER_FREQ)
+
 /* An ATA device. */
 struct disk {
 	char name[8];               /* Name, e.g. "hd0:1". */
@@ -57,8 +64,9 @@ struct disk {
 	bool is_ata;                /* 1=This device is an ATA disk. */
 	disk_sector_t capacity;     /* Capacity in sectors (if is_ata). */
 
-	long long read_cnt;         /* Number of sectors read. */
-	long long write_cnt;        /* Number of sectors written. */
+	/* Statistics, updated atomically. */
+	volatile uint64_t read_cnt; /* Number of sectors read. */
+	volatile uint64_t write_cnt; /* Number of sectors written. */
 };
 
 /* An ATA channel (aka controller).
@@ -72,6 +80,9 @@ struct channel {
 	bool expecting_interrupt;   /* True if an interrupt is expected, false if
 								   any interrupt would be spurious. */
 	struct semaphore completion_wait;   /* Up'd by interrupt handler. */
+	volatile uint32_t spurious_cnt; /* Unexpected interrupts not yet
+	                               reported, updated atomically. */
+	struct work spurious_work;  /* Reports them, outside the handler. */
 
 	struct disk devices[2];     /* The devices on this channel. */
 };
@@ -89,12 +100,14 @@ static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
 
+static void wait_for_interrupt (const struct disk *);
 static void wait_until_idle (const struct disk *);
 static bool wait_while_busy (const struct disk *);
 static void select_device (const struct disk *);
 static void select_device_wait (const struct disk *);
 
 static void interrupt_handler (struct intr_frame *);
+static void report_spurious (struct work *);
 
 /* Initialize the disk subsystem and detect disks. */
 void
@@ -120,8 +133,11 @@ disk_init (void) {
 				NOT_REACHED ();
 		}
 		lock_init (&c->lock);
+		lock_set_name (&c->lock, c->name);
 		c->expecting_interrupt = false;
 		sema_init (&c->completion_wait, 0);
+		c->spurious_cnt = 0;
+		work_init (&c->spurious_work, report_spurious);
 
 		/* Initialize devices. */
 		for (dev_no = 0; dev_no < 2; dev_no++) {
@@ -167,7 +183,7 @@ disk_print_stats (void) {
 		for (dev_no = 0; dev_no < 2; dev_no++) {
 			struct disk *d = disk_get (chan_no, dev_no);
 			if (d != NULL && d->is_ata)
-				printf ("%s: %lld reads, %lld writes\n",
+				printf ("%s: %"PRIu64" reads, %"PRIu64" writes\n",
 						d->name, d->read_cnt, d->write_cnt);
 		}
 	}
@@ -218,12 +234,12 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
 	lock_acquire (&c->lock);
 	select_sector (d, sec_no);
 	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
-	sema_down (&c->completion_wait);
+	wait_for_interrupt (d);
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
 	input_sector (c, buffer);
-	d->read_cnt++;
 	lock_release (&c->lock);
+	xaddq (&d->read_cnt, 1);
 }
 
 /* Write sector SEC_NO to disk D from BUFFER, which must contain
@@ -245,9 +261,9 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
 	output_sector (c, buffer);
-	sema_down (&c->completion_wait);
-	d->write_cnt++;
+	wait_for_interrupt (d);
 	lock_release (&c->lock);
+	xaddq (&d->write_cnt, 1);
 }
 
 /* Disk detection and identification. */
@@ -354,7 +370,7 @@ identify_ata_device (struct disk *d) {
 	   into our buffer. */
 	select_device_wait (d);
 	issue_pio_command (c, CMD_IDENTIFY_DEVICE);
-	sema_down (&c->completion_wait);
+	wait_for_interrupt (d);
 	if (!wait_while_busy (d)) {
 		d->is_ata = false;
 		return;
@@ -490,6 +506,24 @@ wait_while_busy (const struct disk *d) {
 	return false;
 }
 
+/* Waits for the interrupt that D's channel raises when the
+   command just issued to D is done.  If none comes within
+   IRQ_TIMEOUT, it was most likely lost, so stops waiting and
+   leaves it to the status register, which callers check anyway,
+   to tell how the command went.  A late interrupt is then taken
+   as spurious, so that it cannot end the next command's wait. */
+static void
+wait_for_interrupt (const struct disk *d) {
+	struct channel *c = d->channel;
+	enum intr_level old_level = intr_disable ();
+
+	if (!sema_down_timeout (&c->completion_wait, IRQ_TIMEOUT)) {
+		c->expecting_interrupt = false;
+		printf ("%s: interrupt timeout\n", d->name);
+	}
+	intr_set_level (old_level);
+}
+
 /* Program D's channel so that D is now the selected disk. */
 static void
 select_device (const struct disk *d) {
@@ -521,14 +555,31 @@ interrupt_handler (struct intr_frame *f) {
 			if (c->expecting_interrupt) {
 				inb (reg_status (c));               /* Acknowledge interrupt. */
 				sema_up (&c->completion_wait);      /* Wake up waiter. */
-			} else
-				printf ("%s: unexpected interrupt\n", c->name);
+			} else {
+				/* Printing to the console is slow, so leave it to a
+				   worker.  A burst of these is reported once. */
+				xaddl (&c->spurious_cnt, 1);
+				workqueue_queue (&system_wq, &c->spurious_work);
+			}
 			return;
 		}
 
 	NOT_REACHED ();
 }
 
+/* Reports the unexpected interrupts counted by
+   interrupt_handler(). */
+static void
+report_spurious (struct work *w) {
+	struct channel *c = work_entry (w, struct channel, spurious_work);
+	unsigned cnt = xchgl (&c->spurious_cnt, 0);
+
+	if (cnt == 1)
+		printf ("%s: unexpected interrupt\n", c->name);
+	else if (cnt > 1)
+		printf ("%s: %u unexpected interrupts\n", c->name, cnt);
+}
+
 static void
 inspect_read_cnt (struct intr_frame *f) {
 	struct disk * d = disk_get (f->R.rdx, f->R.rcx);
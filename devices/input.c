@@ -38,6 +38,24 @@ input_getc (void) {
 	return key;
 }
 
+/* Retrieves a key from the input buffer into *KEY and returns
+   true, or returns false at once if the buffer is empty. */
+bool
+input_try_getc (uint8_t *key) {
+	enum intr_level old_level;
+	bool got;
+
+	old_level = intr_disable ();
+	got = !intq_empty (&buffer);
+	if (got) {
+		*key = intq_getc (&buffer);
+		serial_notify ();
+	}
+	intr_set_level (old_level);
+
+	return got;
+}
+
 /* Returns true if the input buffer is full,
    false otherwise.
    Interrupts must be off. */
@@ -7,6 +7,7 @@
 #include "threads/io.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -17,38 +18,112 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
+/* 8254 input frequency, in Hz. */
+#define PIT_FREQ 1193180
+
+/* PIT input cycles per timer tick: PIT_FREQ divided by
+   TIMER_FREQ, rounded to nearest. */
+#define PIT_TICK_COUNT ((PIT_FREQ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Longest one-shot, in ticks, that fits in the 16-bit counter
+   even when it also has to cover the rest of the current tick. */
+#define ONESHOT_MAX_TICKS (0xffff / PIT_TICK_COUNT)
+
+/* Fewest PIT cycles, about 5 us, that a high-resolution one-shot
+   is armed for, or leaves over until the next tick boundary.
+   Anything closer is not worth an interrupt of its own. */
+#define HR_MIN_COUNT 6
+
+/* Sleeps shorter than this many nanoseconds busy-wait instead of
+   blocking on an hrtimer, because blocking and waking up again
+   would take about as long. */
+#define HR_MIN_SLEEP_NS 20000
+
+/* Number of timer ticks timer_calibrate() times the TSC over. */
+#define TSC_CALIBRATE_TICKS 5
+
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* Guards ticks and skipped_ticks, so that reading them need not
+   hold off the timer interrupt.  Written only with interrupts off,
+   by the timer interrupt and timer_idle_exit(), which may read
+   them directly. */
+static struct seqlock ticks_seq;
+
+/* If false (default), the PIT interrupts every tick.
+   If true, the idle thread stops the periodic interrupt until the
+   next timer event.  Controlled by kernel command-line option
+   "-tickless". */
+bool timer_tickless;
+
+/* Number of tick boundaries the armed tickless one-shot spans,
+   or 0 if the PIT is in periodic mode. */
+static int64_t oneshot_ticks;
+static int64_t skipped_ticks;   /* # of ticks without an interrupt. */
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Time-stamp counter frequency, in Hz, and the TSC value at
+   timer_ns() time tsc_base_ns.  Initialized by timer_calibrate();
+   until then tsc_hz is 0 and timer_ns() counts whole ticks. */
+static uint64_t tsc_hz;
+static uint64_t tsc_base;
+static int64_t tsc_base_ns;
+
+/* Pending hrtimers, soonest first.  Protected by turning
+   interrupts off. */
+static struct rbtree hrtimers;
+
+/* If true, the PIT is in a one-shot that ends at the first
+   hrtimer, short of the next tick boundary, and hr_rest is the
+   number of PIT cycles from there to the boundary. */
+static bool hr_armed;
+static uint16_t hr_rest;
+static long long hr_interrupt_cnt;  /* # of interrupts between ticks. */
+
+/* Pending timeouts.  Protected by turning interrupts off. */
+static struct wheel timeouts;
+static long long timeout_cnt;   /* # of timeouts that expired. */
+
 static intr_handler_func timer_interrupt;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
+static void pit_set_periodic (void);
+static void pit_set_oneshot (uint16_t count);
+static uint16_t pit_read_count (void);
+static bool pit_output (void);
+static bool pit_irq_pending (void);
+static int64_t next_timer_event (void);
+static bool hrtimer_less (const struct rbtree_elem *,
+		const struct rbtree_elem *, void *aux);
+static void hrtimer_expire (void);
+static void hrtimer_arm (void);
+static void hrtimer_sleep (int64_t ns);
+static void timeout_expire (void);
 
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
    interrupt PIT_FREQ times per second, and registers the
    corresponding interrupt. */
 void
 timer_init (void) {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
-
-	outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb (0x40, count & 0xff);
-	outb (0x40, count >> 8);
-
+	seqlock_init (&ticks_seq);
+	rbtree_init (&hrtimers, hrtimer_less, NULL);
+	wheel_init (&timeouts, 0);
+	pit_set_periodic ();
 	intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Calibrates loops_per_tick, used to implement brief delays, and
+   the time-stamp counter, used by timer_ns(). */
 void
 timer_calibrate (void) {
 	unsigned high_bit, test_bit;
+	int64_t start;
+	uint64_t tsc_start, tsc_end;
 
 	ASSERT (intr_get_level () == INTR_ON);
 	printf ("Calibrating timer...  ");
@@ -68,14 +143,35 @@ timer_calibrate (void) {
 			loops_per_tick |= test_bit;
 
 	printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+
+	/* Count TSC cycles over TSC_CALIBRATE_TICKS whole ticks,
+	   starting at a tick boundary.  timer_ns() is then counted
+	   from that boundary. */
+	start = ticks;
+	while (ticks == start)
+		barrier ();
+	tsc_start = rdtsc ();
+	start = ticks;
+	while (ticks - start < TSC_CALIBRATE_TICKS)
+		barrier ();
+	tsc_end = rdtsc ();
+
+	tsc_base = tsc_start;
+	tsc_base_ns = start * NSEC_PER_TICK;
+	barrier ();
+	tsc_hz = (tsc_end - tsc_start) * TIMER_FREQ / TSC_CALIBRATE_TICKS;
 }
 
 /* Returns the number of timer ticks since the OS booted. */
 int64_t
 timer_ticks (void) {
-	enum intr_level old_level = intr_disable ();
-	int64_t t = ticks;
-	intr_set_level (old_level);
+	uint32_t seq;
+	int64_t t;
+
+	do {
+		seq = seqlock_read_begin (&ticks_seq);
+		t = ticks;
+	} while (seqlock_read_retry (&ticks_seq, seq));
 	barrier ();
 	return t;
 }
@@ -87,6 +183,128 @@ timer_elapsed (int64_t then) {
 	return timer_ticks () - then;
 }
 
+/* Returns the number of nanoseconds since the OS booted.  Unlike
+   timer_ticks(), this counts time between ticks too, from the
+   time-stamp counter, once timer_calibrate() has run.  It never
+   goes backward. */
+int64_t
+timer_ns (void) {
+	uint64_t cycles;
+
+	if (tsc_hz == 0)
+		return timer_ticks () * NSEC_PER_TICK;
+
+	/* Split the division so that CYCLES * NSEC_PER_SEC cannot
+	   overflow. */
+	cycles = rdtsc () - tsc_base;
+	return tsc_base_ns + cycles / tsc_hz * NSEC_PER_SEC
+		+ cycles % tsc_hz * NSEC_PER_SEC / tsc_hz;
+}
+
+/* Initializes hrtimer T to call FUNC when it expires. */
+void
+hrtimer_init (struct hrtimer *t, hrtimer_func *func) {
+	ASSERT (t != NULL);
+	ASSERT (func != NULL);
+
+	t->func = func;
+	t->pending = false;
+}
+
+/* Arranges for T's function to be called from the timer
+   interrupt at timer_ns() time EXPIRES, or as soon after as
+   possible.  If T is already pending, it is moved to EXPIRES.
+   Never calls the function itself, even if EXPIRES has passed,
+   and never sleeps, so it may be called from an interrupt
+   handler. */
+void
+hrtimer_start (struct hrtimer *t, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
+
+	if (t->pending)
+		rbtree_remove (&hrtimers, &t->elem);
+	t->expires = expires;
+	t->pending = true;
+	rbtree_insert (&hrtimers, &t->elem);
+	hrtimer_arm ();
+	intr_set_level (old_level);
+}
+
+/* Stops T from expiring.  Returns true if it was pending, false
+   if it had already expired or was never started. */
+bool
+hrtimer_cancel (struct hrtimer *t) {
+	enum intr_level old_level = intr_disable ();
+	bool pending = t->pending;
+
+	/* If the PIT is armed for T, let the interrupt come anyway:
+	   it finds nothing to do and arms for the next hrtimer. */
+	if (pending) {
+		rbtree_remove (&hrtimers, &t->elem);
+		t->pending = false;
+	}
+	intr_set_level (old_level);
+	return pending;
+}
+
+/* Initializes timeout T to call FUNC when it expires. */
+void
+timeout_init (struct timeout *t, timeout_func *func) {
+	ASSERT (t != NULL);
+	ASSERT (func != NULL);
+
+	t->func = func;
+	t->pending = false;
+}
+
+/* Arranges for T's function to be called from the timer
+   interrupt at timer tick EXPIRES, or at the next tick if EXPIRES
+   has already passed.  T must not be pending.  Never sleeps, so
+   it may be called from an interrupt handler. */
+void
+timeout_add (struct timeout *t, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (!t->pending);
+	t->pending = true;
+	wheel_insert (&timeouts, &t->elem, expires);
+	intr_set_level (old_level);
+}
+
+/* Moves T to expire at timer tick EXPIRES, whether or not it is
+   pending.  Returns true if it was. */
+bool
+timeout_mod (struct timeout *t, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
+	bool pending = timeout_cancel (t);
+
+	timeout_add (t, expires);
+	intr_set_level (old_level);
+	return pending;
+}
+
+/* Stops T from expiring.  Returns true if it was pending, false
+   if it had already expired or was never added.  T's function may
+   be running on another CPU when this returns false. */
+bool
+timeout_cancel (struct timeout *t) {
+	enum intr_level old_level = intr_disable ();
+	bool pending = t->pending;
+
+	if (pending) {
+		wheel_remove (&timeouts, &t->elem);
+		t->pending = false;
+	}
+	intr_set_level (old_level);
+	return pending;
+}
+
+/* Returns true if T is waiting to expire. */
+bool
+timeout_pending (const struct timeout *t) {
+	return t->pending;
+}
+
 /* Suspends execution for approximately TICKS timer ticks. */
 void
 timer_sleep (int64_t ticks) {
@@ -113,16 +331,115 @@ timer_nsleep (int64_t ns) {
 	real_time_sleep (ns, 1000 * 1000 * 1000);
 }
 
+/* Called by the idle thread, with interrupts off, just before it
+   halts the CPU.  In tickless mode, replaces the periodic timer
+   interrupt by a single one at the next timer event, as far as
+   the 16-bit PIT counter reaches. */
+void
+timer_idle_enter (void) {
+	int64_t n;
+	uint16_t left;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (!timer_tickless || oneshot_ticks != 0 || hr_armed)
+		return;
+
+	n = next_timer_event () - ticks;
+	if (n > ONESHOT_MAX_TICKS)
+		n = ONESHOT_MAX_TICKS;
+	if (n <= 1 || pit_irq_pending ())
+		return;
+
+	/* Keep the tick boundaries where they were: the first one is
+	   the rest of the current period away. */
+	left = pit_read_count ();
+	oneshot_ticks = n;
+	pit_set_oneshot (left + (n - 1) * PIT_TICK_COUNT);
+}
+
+/* Called when the idle thread has been woken up, by idle() after
+   the halt and by the scheduler when it switches away from idle.
+   If an interrupt other than the timer's ended the halt, brings
+   `ticks' up to date with the tick boundaries that have passed and
+   arms a one-shot for the rest of the current tick, whose interrupt
+   then resumes periodic mode.  Does nothing if that was already
+   done. */
+void
+timer_idle_exit (void) {
+	enum intr_level old_level = intr_disable ();
+
+	/* If the counter already reached zero, the timer interrupt has
+	   either run or is pending and will do the accounting. */
+	if (oneshot_ticks != 0 && !pit_output ()) {
+		uint16_t remaining = pit_read_count ();
+		int64_t ahead = DIV_ROUND_UP (remaining, PIT_TICK_COUNT);
+		int64_t passed = oneshot_ticks - ahead;
+
+		seqlock_write_begin (&ticks_seq);
+		ticks += passed;
+		skipped_ticks += passed;
+		seqlock_write_end (&ticks_seq);
+		thread_tick_idle (passed);
+
+		oneshot_ticks = 1;
+		pit_set_oneshot (remaining - (ahead - 1) * PIT_TICK_COUNT);
+	}
+	intr_set_level (old_level);
+}
+
 /* Prints timer statistics. */
 void
 timer_print_stats (void) {
-	printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
+	int64_t total, skipped;
+	uint32_t seq;
+
+	do {
+		seq = seqlock_read_begin (&ticks_seq);
+		total = ticks;
+		skipped = skipped_ticks;
+	} while (seqlock_read_retry (&ticks_seq, seq));
+
+	printf ("Timer: %"PRId64" ticks\n", total);
+	if (timer_tickless)
+		printf ("Timer: %"PRId64" ticks skipped in tickless idle\n",
+				skipped);
+	printf ("Timer: TSC at %'"PRIu64" Hz, %lld high-resolution "
+			"interrupts\n", tsc_hz, hr_interrupt_cnt);
+	printf ("Timer: %lld timeouts expired\n", timeout_cnt);
 }
 
 /* Timer interrupt handler. */
 static void
 timer_interrupt (struct intr_frame *args UNUSED) {
+	if (hr_armed) {
+		/* Not a tick, but the first hrtimer's one-shot.  Count
+		   down the rest of the tick in another one-shot, whose
+		   interrupt is then taken as the tick. */
+		hr_armed = false;
+		hr_interrupt_cnt++;
+		oneshot_ticks = 1;
+		pit_set_oneshot (hr_rest);
+		hrtimer_expire ();
+		return;
+	}
+
+	if (oneshot_ticks != 0) {
+		/* A tickless one-shot expired.  Account for the ticks it
+		   covered, except the one counted below, and resume
+		   periodic interrupts. */
+		seqlock_write_begin (&ticks_seq);
+		ticks += oneshot_ticks - 1;
+		skipped_ticks += oneshot_ticks - 1;
+		seqlock_write_end (&ticks_seq);
+		thread_tick_idle (oneshot_ticks - 1);
+		oneshot_ticks = 0;
+		pit_set_periodic ();
+	}
+
+	seqlock_write_begin (&ticks_seq);
 	ticks++;
+	seqlock_write_end (&ticks_seq);
 	thread_tick ();
 	if (thread_mlfqs) {
 		mlfqs_increment();
@@ -137,6 +454,173 @@ timer_interrupt (struct intr_frame *args UNUSED) {
 	if (ticks >= get_next_tick_to_awake()) {
 		thread_awake(ticks);
 	}	
+	timeout_expire ();
+	hrtimer_expire ();
+}
+
+/* Calls the functions of the timeouts that have expired.
+   Interrupts must be off. */
+static void
+timeout_expire (void) {
+	struct wheel_elem *e;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while ((e = wheel_pop_expired (&timeouts, ticks)) != NULL) {
+		struct timeout *t = wheel_entry (e, struct timeout, elem);
+
+		t->pending = false;
+		timeout_cnt++;
+		t->func (t);
+	}
+}
+
+/* Calls the functions of the hrtimers that have expired, then
+   arms the PIT for the next one.  Interrupts must be off. */
+static void
+hrtimer_expire (void) {
+	int64_t now = timer_ns ();
+	struct rbtree_elem *e;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while ((e = rbtree_min (&hrtimers)) != NULL) {
+		struct hrtimer *t = rbtree_entry (e, struct hrtimer, elem);
+
+		if (t->expires > now)
+			break;
+		rbtree_remove (&hrtimers, &t->elem);
+		t->pending = false;
+		t->func (t);
+	}
+	hrtimer_arm ();
+}
+
+/* If the first hrtimer expires before the next tick boundary,
+   splits the current tick in two: a one-shot that ends when it
+   expires, then one for the rest of the tick.  Otherwise the
+   timer interrupt at the boundary expires it.  Does nothing in a
+   tickless one-shot that spans several ticks, because the idle
+   thread ends that as soon as it is woken.  Interrupts must be
+   off. */
+static void
+hrtimer_arm (void) {
+	int64_t delta;
+	uint64_t count;
+	uint32_t now_count, remaining;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (rbtree_empty (&hrtimers) || oneshot_ticks > 1)
+		return;
+
+	/* If a one-shot already ran out, the timer interrupt is
+	   coming and will arm again. */
+	if (pit_irq_pending ()
+			|| ((oneshot_ticks != 0 || hr_armed) && pit_output ()))
+		return;
+
+	delta = rbtree_entry (rbtree_min (&hrtimers), struct hrtimer,
+			elem)->expires - timer_ns ();
+	count = delta <= 0 ? 0 : DIV_ROUND_UP ((uint64_t) delta * PIT_FREQ,
+			NSEC_PER_SEC);
+	if (count < HR_MIN_COUNT)
+		count = HR_MIN_COUNT;
+
+	now_count = pit_read_count ();
+	if (hr_armed && count >= now_count)
+		return;
+	remaining = now_count + (hr_armed ? hr_rest : 0);
+	if (count + HR_MIN_COUNT > remaining)
+		return;
+
+	hr_armed = true;
+	hr_rest = remaining - count;
+	oneshot_ticks = 0;
+	pit_set_oneshot (count);
+}
+
+/* Orders hrtimers by expiry time. */
+static bool
+hrtimer_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct hrtimer *a = rbtree_entry (a_, struct hrtimer, elem);
+	const struct hrtimer *b = rbtree_entry (b_, struct hrtimer, elem);
+
+	return a->expires < b->expires;
+}
+
+/* Returns the tick of the next event that needs the timer
+   interrupt: a sleeping thread's wake up tick, a timeout, an
+   hrtimer, or, for the advanced scheduler, the next once-per-
+   second recalculation. */
+static int64_t
+next_timer_event (void) {
+	int64_t next = get_next_tick_to_awake ();
+
+	if (wheel_next (&timeouts) < next)
+		next = wheel_next (&timeouts);
+	if (!rbtree_empty (&hrtimers)) {
+		/* The tick boundary at or before the first hrtimer, from
+		   which hrtimer_arm() can time the rest. */
+		int64_t delta = rbtree_entry (rbtree_min (&hrtimers),
+				struct hrtimer, elem)->expires - timer_ns ();
+		int64_t hr = ticks + (delta > 0 ? delta / NSEC_PER_TICK : 0);
+		if (hr < next)
+			next = hr;
+	}
+	if (thread_mlfqs) {
+		int64_t second = (ticks / TIMER_FREQ + 1) * TIMER_FREQ;
+		if (second < next)
+			next = second;
+	}
+	return next;
+}
+
+/* Programs PIT counter 0 to interrupt every PIT_TICK_COUNT
+   cycles, that is, TIMER_FREQ times per second. */
+static void
+pit_set_periodic (void) {
+	outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb (0x40, PIT_TICK_COUNT & 0xff);
+	outb (0x40, PIT_TICK_COUNT >> 8);
+}
+
+/* Programs PIT counter 0 to interrupt once, COUNT cycles from
+   now. */
+static void
+pit_set_oneshot (uint16_t count) {
+	outb (0x43, 0x30);    /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb (0x40, count & 0xff);
+	outb (0x40, count >> 8);
+}
+
+/* Returns the current value of PIT counter 0. */
+static uint16_t
+pit_read_count (void) {
+	uint8_t lo, hi;
+
+	outb (0x43, 0x00);    /* Counter latch command for counter 0. */
+	lo = inb (0x40);
+	hi = inb (0x40);
+	return lo | (hi << 8);
+}
+
+/* Returns the state of PIT counter 0's output pin, which in mode
+   0 goes high when the count reaches zero. */
+static bool
+pit_output (void) {
+	outb (0x43, 0xe2);    /* Read-back: status only, counter 0. */
+	return (inb (0x40) & 0x80) != 0;
+}
+
+/* Returns true if the master PIC has a timer interrupt waiting
+   to be delivered, which would be mistaken for the end of a
+   one-shot. */
+static bool
+pit_irq_pending (void) {
+	outb (0x20, 0x0a);    /* OCW3: read the interrupt request register. */
+	return (inb (0x20) & 0x01) != 0;
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -170,26 +654,54 @@ busy_wait (int64_t loops) {
 		barrier ();
 }
 
+/* A thread blocked in hrtimer_sleep(). */
+struct hr_sleeper {
+	struct hrtimer timer;           /* Expires when it should wake. */
+	struct thread *thread;          /* The sleeping thread. */
+};
+
+/* hrtimer function for hrtimer_sleep(): wakes the sleeper. */
+static void
+hrtimer_wake (struct hrtimer *t) {
+	struct hr_sleeper *s = hrtimer_entry (t, struct hr_sleeper, timer);
+
+	thread_unblock (s->thread);
+	test_max_priority ();
+}
+
+/* Blocks the running thread for NS nanoseconds. */
+static void
+hrtimer_sleep (int64_t ns) {
+	struct hr_sleeper s;
+	enum intr_level old_level;
+
+	hrtimer_init (&s.timer, hrtimer_wake);
+	s.thread = thread_current ();
+
+	/* hrtimer_start() never runs the function itself, so the
+	   wakeup cannot come before thread_block(). */
+	old_level = intr_disable ();
+	hrtimer_start (&s.timer, timer_ns () + ns);
+	thread_block ();
+	intr_set_level (old_level);
+}
+
 /* Sleep for approximately NUM/DENOM seconds. */
 static void
 real_time_sleep (int64_t num, int32_t denom) {
-	/* Convert NUM/DENOM seconds into timer ticks, rounding down.
-
-	   (NUM / DENOM) s
-	   ---------------------- = NUM * TIMER_FREQ / DENOM ticks.
-	   1 s / TIMER_FREQ ticks
-	   */
-	int64_t ticks = num * TIMER_FREQ / denom;
+	/* Convert NUM/DENOM seconds into nanoseconds.  DENOM divides
+	   NSEC_PER_SEC. */
+	int64_t ns = num * (NSEC_PER_SEC / denom);
 
 	ASSERT (intr_get_level () == INTR_ON);
-	if (ticks > 0) {
-		/* We're waiting for at least one full timer tick.  Use
-		   timer_sleep() because it will yield the CPU to other
-		   processes. */
-		timer_sleep (ticks);
+	if (ns >= HR_MIN_SLEEP_NS) {
+		/* Block on an hrtimer, which yields the CPU to other
+		   processes and, unlike timer_sleep(), wakes us between
+		   ticks. */
+		hrtimer_sleep (ns);
 	} else {
-		/* Otherwise, use a busy-wait loop for more accurate
-		   sub-tick timing.  We scale the numerator and denominator
+		/* Otherwise, use a busy-wait loop, since the sleep is too
+		   short to be worth blocking for.  We scale the numerator and denominator
 		   down by 1000 to avoid the possibility of overflow. */
 		ASSERT (denom % 1000 == 0);
 		busy_wait (loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000));
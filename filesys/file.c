@@ -2,10 +2,17 @@
 #include <debug.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
-/* An open file. */
+/* An open file.
+
+   The threads of a process share its open files, and system calls
+   may read different files at once, so the position has a lock of
+   its own: a read or write holds it from using the position to
+   advancing it. */
 struct file {
 	struct inode *inode;        /* File's inode. */
+	struct lock pos_lock;       /* Protects pos. */
 	off_t pos;                  /* Current position. */
 	bool deny_write;            /* Has file_deny_write() been called? */
 };
@@ -18,6 +25,7 @@ file_open (struct inode *inode) {
 	struct file *file = calloc (1, sizeof *file);
 	if (inode != NULL && file != NULL) {
 		file->inode = inode;
+		lock_init (&file->pos_lock);
 		file->pos = 0;
 		file->deny_write = false;
 		return file;
@@ -41,7 +49,7 @@ struct file *
 file_duplicate (struct file *file) {
 	struct file *nfile = file_open (inode_reopen (file->inode));
 	if (nfile) {
-		nfile->pos = file->pos;
+		nfile->pos = file_tell (file);
 		if (file->deny_write)
 			file_deny_write (nfile);
 	}
@@ -71,8 +79,12 @@ file_get_inode (struct file *file) {
  * Advances FILE's position by the number of bytes read. */
 off_t
 file_read (struct file *file, void *buffer, off_t size) {
-	off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
+	off_t bytes_read;
+
+	lock_acquire (&file->pos_lock);
+	bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
 	file->pos += bytes_read;
+	lock_release (&file->pos_lock);
 	return bytes_read;
 }
 
@@ -95,8 +107,12 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs) {
  * Advances FILE's position by the number of bytes read. */
 off_t
 file_write (struct file *file, const void *buffer, off_t size) {
-	off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
+	off_t bytes_written;
+
+	lock_acquire (&file->pos_lock);
+	bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
 	file->pos += bytes_written;
+	lock_release (&file->pos_lock);
 	return bytes_written;
 }
 
@@ -149,13 +165,20 @@ void
 file_seek (struct file *file, off_t new_pos) {
 	ASSERT (file != NULL);
 	ASSERT (new_pos >= 0);
+	lock_acquire (&file->pos_lock);
 	file->pos = new_pos;
+	lock_release (&file->pos_lock);
 }
 
 /* Returns the current position in FILE as a byte offset from the
  * start of the file. */
 off_t
 file_tell (struct file *file) {
+	off_t pos;
+
 	ASSERT (file != NULL);
-	return file->pos;
+	lock_acquire (&file->pos_lock);
+	pos = file->pos;
+	lock_release (&file->pos_lock);
+	return pos;
 }
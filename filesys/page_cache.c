@@ -1,6 +1,7 @@
 /* page_cache.c: Implementation of Page Cache (Buffer Cache). */
 
 #include "vm/vm.h"
+#include "threads/workqueue.h"
 static bool page_cache_readahead (struct page *page, void *kva);
 static bool page_cache_writeback (struct page *page);
 static void page_cache_destroy (struct page *page);
@@ -13,12 +14,14 @@ static const struct page_operations page_cache_op = {
 	.type = VM_PAGE_CACHE,
 };
 
-tid_t page_cache_workerd;
+/* Runs read-ahead and write-back for the page cache, at a
+   priority below ordinary threads. */
+static struct workqueue page_cache_wq;
 
 /* The initializer of file vm */
 void
 pagecache_init (void) {
-	/* TODO: Create a worker daemon for page cache with page_cache_kworkerd */
+	workqueue_init (&page_cache_wq, "pgcache", PRI_DEFAULT - 1, 1);
 }
 
 /* Initialize the page cache */
@@ -44,7 +47,3 @@ static void
 page_cache_destroy (struct page *page) {
 }
 
-/* Worker thread for page cache */
-static void
-page_cache_kworkerd (void *aux) {
-}
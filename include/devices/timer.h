@@ -1,23 +1,100 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <rbtree.h>
 #include <round.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <wheel.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Nanoseconds per second and per timer tick. */
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_TICK (NSEC_PER_SEC / TIMER_FREQ)
+
+/* High-resolution timer.
+
+   Calls a function from the timer interrupt once timer_ns()
+   reaches a given time.  If that comes between two ticks, the
+   timer chip is set to interrupt just then, rather than at the
+   next tick.  The function runs with interrupts off, so it must
+   not sleep.
+
+   Like the kernel containers, hrtimers do no allocation: embed a
+   struct hrtimer in a structure of your own and use
+   hrtimer_entry() to get back to it from the function. */
+struct hrtimer;
+typedef void hrtimer_func (struct hrtimer *);
+
+struct hrtimer {
+	struct rbtree_elem elem;        /* Element in the timer queue. */
+	int64_t expires;                /* When to run, in timer_ns() time. */
+	hrtimer_func *func;             /* Function to run. */
+	bool pending;                   /* In the queue? */
+};
+
+/* Converts pointer to hrtimer HRTIMER into a pointer to the
+   structure that HRTIMER is embedded inside.  Supply the name of
+   the outer structure STRUCT and the member name MEMBER of the
+   hrtimer. */
+#define hrtimer_entry(HRTIMER, STRUCT, MEMBER)                  \
+	((STRUCT *) ((uint8_t *) (HRTIMER) - offsetof (STRUCT, MEMBER)))
+
+/* Timeout.
+
+   Calls a function from the timer interrupt at a given timer
+   tick.  Timeouts are kept in a timing wheel, so adding,
+   changing and canceling one take constant time however many are
+   pending, which suits watchdogs and timed waits that are nearly
+   always canceled before they expire.  Use an hrtimer when a tick
+   is too coarse.  The function runs with interrupts off, so it
+   must not sleep, but it may add its timeout again. */
+struct timeout;
+typedef void timeout_func (struct timeout *);
+
+struct timeout {
+	struct wheel_elem elem;         /* Element in the timeout wheel. */
+	timeout_func *func;             /* Function to run. */
+	bool pending;                   /* In the wheel? */
+};
+
+/* Converts pointer to timeout TIMEOUT into a pointer to the
+   structure that TIMEOUT is embedded inside.  Supply the name of
+   the outer structure STRUCT and the member name MEMBER of the
+   timeout. */
+#define timeout_entry(TIMEOUT, STRUCT, MEMBER)                  \
+	((STRUCT *) ((uint8_t *) (TIMEOUT) - offsetof (STRUCT, MEMBER)))
+
 void timer_init (void);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_ns (void);
+
+void hrtimer_init (struct hrtimer *, hrtimer_func *);
+void hrtimer_start (struct hrtimer *, int64_t expires);
+bool hrtimer_cancel (struct hrtimer *);
+
+void timeout_init (struct timeout *, timeout_func *);
+void timeout_add (struct timeout *, int64_t expires);
+bool timeout_mod (struct timeout *, int64_t expires);
+bool timeout_cancel (struct timeout *);
+bool timeout_pending (const struct timeout *);
 
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
 
+extern bool timer_tickless;
+
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+
 void timer_print_stats (void);
 
 #endif /* devices/timer.h */
@@ -119,6 +119,163 @@ static __inline uint64_t rcr2(void) {
 	return val;
 }
 
+__attribute__((always_inline))
+static __inline uint64_t rcr0(void) {
+	uint64_t val;
+	__asm __volatile("movq %%cr0,%0" : "=r" (val));
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline void lcr0(uint64_t val) {
+	__asm __volatile("movq %0, %%cr0" : : "r" (val));
+}
+
+__attribute__((always_inline))
+static __inline uint64_t rcr4(void) {
+	uint64_t val;
+	__asm __volatile("movq %%cr4,%0" : "=r" (val));
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline void lcr4(uint64_t val) {
+	__asm __volatile("movq %0, %%cr4" : : "r" (val));
+}
+
+/* Clears CR0.TS, so that the next FPU or SSE instruction does
+   not raise #NM.  See [IA32-v2a] "CLTS--Clear Task-Switched Flag
+   in CR0". */
+__attribute__((always_inline))
+static __inline void clts(void) {
+	__asm __volatile("clts" : : : "memory");
+}
+
+/* Saves the x87, MMX and SSE state into the 512-byte, 16-byte
+   aligned area at AREA.  See [IA32-v2a] "FXSAVE--Save x87 FPU,
+   MMX Technology, and SSE State". */
+__attribute__((always_inline))
+static __inline void fxsave(void *area) {
+	__asm __volatile("fxsave64 (%0)" : : "r" (area) : "memory");
+}
+
+/* Loads the state saved by fxsave() from AREA. */
+__attribute__((always_inline))
+static __inline void fxrstor(const void *area) {
+	__asm __volatile("fxrstor64 (%0)" : : "r" (area) : "memory");
+}
+
+/* Returns the index of the most significant set bit in VAL,
+   which must be nonzero.  See [IA32-v2a] "BSR--Bit Scan Reverse". */
+__attribute__((always_inline))
+static __inline int bsrq(uint64_t val) {
+	uint64_t idx;
+	__asm __volatile("bsrq %1,%0" : "=r" (idx) : "rm" (val) : "cc");
+	return idx;
+}
+
+/* Returns the index of the least significant set bit in VAL,
+   which must be nonzero.  See [IA32-v2a] "BSF--Bit Scan Forward". */
+__attribute__((always_inline))
+static __inline int bsfq(uint64_t val) {
+	uint64_t idx;
+	__asm __volatile("bsfq %1,%0" : "=r" (idx) : "rm" (val) : "cc");
+	return idx;
+}
+
+/* Atomic operations.
+
+   Each of these is a single locked instruction, so it is atomic
+   with respect to other CPUs as well as to interrupts, and is a
+   full memory barrier for the compiler and the CPU alike.  They
+   suit counters and flags that are updated often but need no
+   other data kept consistent with them; for anything more, use a
+   lock.  See [IA32-v3a] 8.1.2 "Bus Locking". */
+
+/* Atomically stores VAL into *ADDR and returns the old value.
+   XCHG with a memory operand is implicitly locked.  See
+   [IA32-v2b] "XCHG--Exchange Register/Memory with Register". */
+__attribute__((always_inline))
+static __inline uint32_t xchgl(volatile uint32_t *addr, uint32_t val) {
+	__asm __volatile("xchgl %0,%1" : "+r" (val), "+m" (*addr) : : "memory");
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline uint64_t xchgq(volatile uint64_t *addr, uint64_t val) {
+	__asm __volatile("xchgq %0,%1" : "+r" (val), "+m" (*addr) : : "memory");
+	return val;
+}
+
+/* Atomically adds VAL to *ADDR and returns the old value.  See
+   [IA32-v2b] "XADD--Exchange and Add". */
+__attribute__((always_inline))
+static __inline uint32_t xaddl(volatile uint32_t *addr, uint32_t val) {
+	__asm __volatile("lock xaddl %0,%1" : "+r" (val), "+m" (*addr) : : "memory", "cc");
+	return val;
+}
+
+__attribute__((always_inline))
+static __inline uint64_t xaddq(volatile uint64_t *addr, uint64_t val) {
+	__asm __volatile("lock xaddq %0,%1" : "+r" (val), "+m" (*addr) : : "memory", "cc");
+	return val;
+}
+
+/* Atomically stores NEW into *ADDR if *ADDR equals OLD.  Returns
+   the value *ADDR had, which is OLD exactly when NEW was stored.
+   See [IA32-v2a] "CMPXCHG--Compare and Exchange". */
+__attribute__((always_inline))
+static __inline uint32_t cmpxchgl(volatile uint32_t *addr, uint32_t old,
+		uint32_t new) {
+	__asm __volatile("lock cmpxchgl %2,%1"
+			: "+a" (old), "+m" (*addr) : "r" (new) : "memory", "cc");
+	return old;
+}
+
+__attribute__((always_inline))
+static __inline uint64_t cmpxchgq(volatile uint64_t *addr, uint64_t old,
+		uint64_t new) {
+	__asm __volatile("lock cmpxchgq %2,%1"
+			: "+a" (old), "+m" (*addr) : "r" (new) : "memory", "cc");
+	return old;
+}
+
+/* Memory barriers.  mfence() orders all earlier loads and stores
+   before all later ones, lfence() only loads, and sfence() only
+   stores.  Ordinary x86 loads and stores are already ordered except
+   that a later load may pass an earlier store, so mfence() is the
+   one usually needed.  See [IA32-v3a] 8.2 "Memory Ordering". */
+__attribute__((always_inline))
+static __inline void mfence(void) {
+	__asm __volatile("mfence" : : : "memory");
+}
+
+__attribute__((always_inline))
+static __inline void lfence(void) {
+	__asm __volatile("lfence" : : : "memory");
+}
+
+__attribute__((always_inline))
+static __inline void sfence(void) {
+	__asm __volatile("sfence" : : : "memory");
+}
+
+/* Hints to the processor that this is a spin-wait loop.  See
+   [IA32-v2b] "PAUSE--Spin Loop Hint". */
+__attribute__((always_inline))
+static __inline void cpu_relax(void) {
+	__asm __volatile("pause" : : : "memory");
+}
+
+/* Returns the time-stamp counter, which counts processor cycles.
+   See [IA32-v2b] "RDTSC--Read Time-Stamp Counter". */
+__attribute__((always_inline))
+static __inline uint64_t rdtsc(void) {
+	uint32_t lo, hi;
+	__asm __volatile("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((uint64_t) hi << 32) | lo;
+}
+
 __attribute__((always_inline))
 static __inline void write_msr(uint32_t ecx, uint64_t val) {
 	uint32_t edx, eax;
@@ -0,0 +1,20 @@
+#ifndef __LIB_CLOCK_H
+#define __LIB_CLOCK_H
+
+#include <stdint.h>
+
+/* Clocks that the clock_gettime() system call can read.
+
+   CLOCK_MONOTONIC counts the time since the OS booted, to the
+   nanosecond, and never goes backward.  There is no clock of the
+   time of day, because the kernel does not read the real-time
+   clock chip. */
+#define CLOCK_MONOTONIC 1
+
+/* A time, in seconds and nanoseconds. */
+struct timespec {
+	int64_t tv_sec;                 /* Seconds. */
+	long tv_nsec;                   /* Nanoseconds, 0 to 999,999,999. */
+};
+
+#endif /* lib/clock.h */
@@ -0,0 +1,23 @@
+#ifndef __LIB_FUTEX_H
+#define __LIB_FUTEX_H
+
+/* Operations of the futex() system call.
+
+   A futex is an int in user memory that user code updates with
+   atomic instructions, and uses the kernel only to sleep and be
+   woken, so that a lock built on one enters the kernel only when
+   it is contended.
+
+   FUTEX_WAIT sleeps until woken by FUTEX_WAKE on the same
+   address, unless the int no longer holds VAL, in which case it
+   returns -1 at once.  The check and the sleep are atomic with
+   respect to FUTEX_WAKE, so a wakeup cannot be lost between a
+   caller's last look at the int and its going to sleep.  It
+   returns 0 when woken.
+
+   FUTEX_WAKE wakes up to VAL threads sleeping on the address, in
+   the order they began to wait, and returns the number woken. */
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+
+#endif /* lib/futex.h */
@@ -0,0 +1,71 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+ *
+ * A red-black tree is a binary search tree that keeps itself
+ * balanced, so that insertion, deletion and lookup all take
+ * O(lg n) time in the worst case.  This implementation also caches
+ * the minimum element, so rbtree_min() is O(1), which suits using
+ * the tree as a priority queue that is always drained from the
+ * front, as the scheduler does.
+ *
+ * Like the other kernel containers, the tree does no dynamic
+ * allocation.  Each structure that can be in a tree embeds a
+ * struct rbtree_elem, and rbtree_entry() converts a struct
+ * rbtree_elem back to the structure that contains it, just as
+ * list_entry() does for lists.  An element may be in at most one
+ * tree at a time.
+ *
+ * Elements are ordered by a caller-supplied rbtree_less_func.
+ * Elements that compare equal are allowed; a new element goes
+ * after the equal elements already in the tree, so equal elements
+ * come out in insertion order. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Red-black tree element. */
+struct rbtree_elem {
+	struct rbtree_elem *parent;     /* Parent, or null for the root. */
+	struct rbtree_elem *left;       /* Left child, or null. */
+	struct rbtree_elem *right;      /* Right child, or null. */
+	bool red;                       /* Red or black? */
+};
+
+/* Converts pointer to tree element RBTREE_ELEM into a pointer to
+ * the structure that RBTREE_ELEM is embedded inside.  Supply the
+ * name of the outer structure STRUCT and the member name MEMBER
+ * of the tree element. */
+#define rbtree_entry(RBTREE_ELEM, STRUCT, MEMBER)               \
+	((STRUCT *) ((uint8_t *) (RBTREE_ELEM)                  \
+		- offsetof (STRUCT, MEMBER)))
+
+/* Compares the value of two tree elements A and B, given
+ * auxiliary data AUX.  Returns true if A is less than B, or
+ * false if A is greater than or equal to B. */
+typedef bool rbtree_less_func (const struct rbtree_elem *a,
+		const struct rbtree_elem *b, void *aux);
+
+/* Red-black tree. */
+struct rbtree {
+	struct rbtree_elem *root;       /* Root, or null if empty. */
+	struct rbtree_elem *min;        /* Leftmost element, or null. */
+	size_t elem_cnt;                /* Number of elements. */
+	rbtree_less_func *less;         /* Comparison function. */
+	void *aux;                      /* Auxiliary data for `less'. */
+};
+
+void rbtree_init (struct rbtree *, rbtree_less_func *, void *aux);
+void rbtree_insert (struct rbtree *, struct rbtree_elem *);
+void rbtree_remove (struct rbtree *, struct rbtree_elem *);
+
+struct rbtree_elem *rbtree_min (struct rbtree *);
+struct rbtree_elem *rbtree_max (struct rbtree *);
+struct rbtree_elem *rbtree_next (struct rbtree_elem *);
+
+size_t rbtree_size (struct rbtree *);
+bool rbtree_empty (struct rbtree *);
+
+#endif /* lib/kernel/rbtree.h */
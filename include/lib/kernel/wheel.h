@@ -0,0 +1,81 @@
+#ifndef __LIB_KERNEL_WHEEL_H
+#define __LIB_KERNEL_WHEEL_H
+
+/* Hierarchical timing wheel.
+ *
+ * A timing wheel holds elements keyed by an expiration time, in
+ * timer ticks, and hands them back once that time has been
+ * reached.  Insertion is O(1), and expiring K elements costs
+ * O(K), amortized, no matter how many other elements are in the
+ * wheel.  The earliest expiration time is always known exactly,
+ * so a caller can cheaply decide whether any work is due.
+ *
+ * The wheel has WHEEL_LEVELS levels of WHEEL_SLOTS slots each.
+ * An element is placed by comparing its expiration time with the
+ * wheel's clock: the highest bit in which the two differ selects
+ * the level, and the WHEEL_BITS-bit digit of the expiration time
+ * at that level selects the slot.  Level 0 therefore holds the
+ * elements that expire within the current 64-tick window, one
+ * tick per slot, level 1 those within the current 4096-tick
+ * window, and so on.  When the clock advances, only the one slot
+ * per level whose digit the clock now shares has to be moved
+ * ("cascaded") down a level.
+ *
+ * Like the other kernel containers, the wheel does no dynamic
+ * allocation.  Each structure that can be in a wheel embeds a
+ * struct wheel_elem, and wheel_entry() converts a struct
+ * wheel_elem back to the structure that contains it, just as
+ * list_entry() does for lists.  An element may be in at most one
+ * wheel at a time. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "list.h"
+
+/* Number of bits of the expiration time resolved per level. */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+
+/* Enough levels to cover every nonnegative int64_t. */
+#define WHEEL_LEVELS ((63 + WHEEL_BITS - 1) / WHEEL_BITS)
+
+/* Wheel element. */
+struct wheel_elem {
+	struct list_elem list_elem;
+	int64_t expires;            /* Expiration time, in ticks. */
+};
+
+/* Converts pointer to wheel element WHEEL_ELEM into a pointer to
+ * the structure that WHEEL_ELEM is embedded inside.  Supply the
+ * name of the outer structure STRUCT and the member name MEMBER
+ * of the wheel element. */
+#define wheel_entry(WHEEL_ELEM, STRUCT, MEMBER)                 \
+	((STRUCT *) ((uint8_t *) &(WHEEL_ELEM)->list_elem       \
+		- offsetof (STRUCT, MEMBER.list_elem)))
+
+/* Performs some operation on wheel element E, given auxiliary
+ * data AUX. */
+typedef void wheel_action_func (struct wheel_elem *e, void *aux);
+
+/* Timing wheel. */
+struct wheel {
+	int64_t clock;              /* Elements due at or before this are in `due'. */
+	int64_t next;               /* Earliest expiration, INT64_MAX if none. */
+	size_t elem_cnt;            /* Number of elements, including `due'. */
+	uint64_t occupied[WHEEL_LEVELS];    /* Bit S set iff slot S nonempty. */
+	struct list slots[WHEEL_LEVELS][WHEEL_SLOTS];
+	struct list due;            /* Expired, not yet popped. */
+};
+
+void wheel_init (struct wheel *, int64_t clock);
+void wheel_insert (struct wheel *, struct wheel_elem *, int64_t expires);
+void wheel_remove (struct wheel *, struct wheel_elem *);
+struct wheel_elem *wheel_pop_expired (struct wheel *, int64_t now);
+void wheel_apply (struct wheel *, wheel_action_func *, void *aux);
+
+int64_t wheel_next (struct wheel *);
+size_t wheel_size (struct wheel *);
+bool wheel_empty (struct wheel *);
+
+#endif /* lib/kernel/wheel.h */
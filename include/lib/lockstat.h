@@ -0,0 +1,32 @@
+#ifndef __LIB_LOCKSTAT_H
+#define __LIB_LOCKSTAT_H
+
+#include <stdint.h>
+
+/* Contention statistics for one class of kernel locks, as returned
+   by the lockstat() system call.
+
+   The kernel keeps statistics only for locks it has named with
+   lock_set_name(), and locks given the same name, such as the
+   locks of all the malloc() descriptors, are counted together.
+   An acquisition is contended if the lock was held when it was
+   attempted, so that the thread had to wait for it.
+
+   Times are in CPU cycles, as counted by the time-stamp counter,
+   since most waits and holds are far shorter than a timer tick. */
+
+/* Longest lock name, not counting the null terminator. */
+#define LOCKSTAT_NAME_LEN 15
+
+/* Most lock names the kernel keeps statistics for. */
+#define LOCKSTAT_MAX 32
+
+struct lockstat {
+	char name[LOCKSTAT_NAME_LEN + 1];       /* Name given to the locks. */
+	uint64_t acquire_cnt;           /* Acquisitions. */
+	uint64_t contended_cnt;         /* Of those, ones that waited. */
+	uint64_t wait_cycles;           /* Total time spent waiting. */
+	uint64_t hold_max;              /* Longest time held. */
+};
+
+#endif /* lib/lockstat.h */
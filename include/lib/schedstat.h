@@ -0,0 +1,42 @@
+#ifndef __LIB_SCHEDSTAT_H
+#define __LIB_SCHEDSTAT_H
+
+#include <stdint.h>
+
+/* Scheduling statistics, as returned by the schedstat() system
+   call for one thread or for the whole system.  All times are in
+   timer ticks.
+
+   A switch is voluntary if the thread blocked, and involuntary if
+   it was still runnable, that is, if it was preempted or its time
+   slice ran out.
+
+   Wakeup latency is the time from a thread being unblocked to its
+   being run.  Bucket 0 of the histogram counts wakeups that ran
+   within the same tick, and bucket N, for N > 0, those that waited
+   at least 2**(N-1) and less than 2**N ticks; the last bucket also
+   counts everything longer.
+
+   The EDF counters are for real-time threads (see
+   thread_set_deadline()).  A job is missed if it ends after its
+   deadline, and a thread is throttled each time it uses up its
+   runtime for a period. */
+#define SCHED_LAT_BUCKETS 12
+
+struct sched_stats {
+	int64_t run_ticks;              /* Ticks spent running. */
+	int64_t wait_ticks;             /* Ticks spent ready, not running. */
+	int64_t nvcsw;                  /* Voluntary context switches. */
+	int64_t nivcsw;                 /* Involuntary context switches. */
+	int64_t wakeup_cnt;             /* Wakeups counted in lat_hist. */
+	int64_t lat_max;                /* Longest wakeup latency. */
+	int64_t lat_hist[SCHED_LAT_BUCKETS];    /* Wakeup latency histogram. */
+	int64_t edf_jobs;               /* Real-time jobs ended. */
+	int64_t edf_misses;             /* Of those, jobs that were late. */
+	int64_t edf_throttles;          /* Times throttled. */
+};
+
+/* Pass as the PID to schedstat() to get system-wide totals. */
+#define SCHEDSTAT_ALL (-1)
+
+#endif /* lib/schedstat.h */
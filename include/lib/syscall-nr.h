@@ -36,6 +36,21 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Scheduling. */
+	SYS_SCHEDSTAT,              /* Get scheduling statistics. */
+
+	/* Synchronization. */
+	SYS_FUTEX,                  /* Wait on or wake a futex. */
+	SYS_LOCKSTAT,               /* Get kernel lock statistics. */
+
+	/* Threads. */
+	SYS_UTHREAD_CREATE,         /* Start a thread in this process. */
+	SYS_UTHREAD_EXIT,           /* Terminate this thread. */
+	SYS_UTHREAD_JOIN,           /* Wait for a thread to die. */
+
+	/* Time. */
+	SYS_CLOCK_GETTIME,          /* Read a clock. */
 };
 
 #endif /* lib/syscall-nr.h */
@@ -4,11 +4,22 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <schedstat.h>
+#include <lockstat.h>
+#include <futex.h>
+#include <clock.h>
 
 /* Process identifier. */
 typedef int pid_t;
 #define PID_ERROR ((pid_t) -1)
 
+/* Thread identifier. */
+typedef int tid_t;
+#define TID_ERROR ((tid_t) -1)
+
+/* Function run by a thread started with uthread_create(). */
+typedef void uthread_func (void *aux);
+
 /* Map region identifier. */
 typedef int off_t;
 #define MAP_FAILED ((void *) NULL)
@@ -38,6 +49,16 @@ void close (int fd);
 
 int dup2(int oldfd, int newfd);
 
+bool schedstat (pid_t, struct sched_stats *);
+int futex (int *uaddr, int op, int val);
+int lockstat (struct lockstat *, int cnt);
+
+tid_t uthread_create (uthread_func *, void *aux);
+void uthread_exit (int status) NO_RETURN;
+int uthread_join (tid_t);
+
+int clock_gettime (int clock, struct timespec *);
+
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
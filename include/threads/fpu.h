@@ -0,0 +1,38 @@
+#ifndef THREADS_FPU_H
+#define THREADS_FPU_H
+
+/* Lazy FPU state switching.
+ *
+ * The x87, MMX and SSE registers belong to whichever thread last
+ * used them, the "owner", and stay loaded across context switches.
+ * When any other thread is switched in, CR0.TS is set, so that its
+ * first FPU or SSE instruction raises #NM (Device Not Available).
+ * The #NM handler saves the owner's registers into the owner's
+ * save area, loads the current thread's, and makes it the owner.
+ * A thread that never touches the FPU therefore costs nothing at
+ * context switch time, and a thread that is the only FPU user
+ * keeps its registers loaded indefinitely.
+ *
+ * The kernel itself is compiled with -mno-sse and never uses the
+ * FPU, so in practice only user programs trap, apart from kernel
+ * threads that use it on purpose, as the fpu-switch test does.  Each thread's
+ * save area is the FPU_AREA_SIZE bytes at the top of the page
+ * that holds its struct thread (see threads/kstack.h).  The
+ * initial thread has none and must never use the FPU. */
+
+#include <stdbool.h>
+
+/* Size of an FXSAVE area, in bytes. */
+#define FPU_AREA_SIZE 512
+
+struct thread;
+
+void fpu_init (void);
+void fpu_init_thread (struct thread *);
+void fpu_switch (struct thread *next);
+void fpu_release (struct thread *);
+void fpu_copy (struct thread *dst, struct thread *src);
+void fpu_reset (void);
+void fpu_print_stats (void);
+
+#endif /* threads/fpu.h */
@@ -14,6 +14,13 @@ enum intr_level intr_get_level (void);
 enum intr_level intr_set_level (enum intr_level);
 enum intr_level intr_enable (void);
 enum intr_level intr_disable (void);
+enum intr_level intr_disable_at (const void *caller);
+
+/* If true, time how long interrupts stay off.  Controlled by
+   kernel command-line option "-intr-trace". */
+extern bool intr_trace;
+void intr_trace_sti (void);
+void intr_print_stats (void);
 
 /* Interrupt stack frame. */
 struct gp_registers {
@@ -69,6 +76,7 @@ void intr_init (void);
 void intr_register_ext (uint8_t vec, intr_handler_func *, const char *name);
 void intr_register_int (uint8_t vec, int dpl, enum intr_level,
                         intr_handler_func *, const char *name);
+void intr_set_ist (uint8_t vec, unsigned ist);
 bool intr_context (void);
 void intr_yield_on_return (void);
 
@@ -0,0 +1,37 @@
+#ifndef THREADS_KSTACK_H
+#define THREADS_KSTACK_H
+
+#include <stddef.h>
+#include "threads/vaddr.h"
+
+/* Kernel stacks.
+ *
+ * Each thread other than the initial one gets a KSTACK_SIZE region,
+ * aligned to KSTACK_SIZE, laid out like this:
+ *
+ *   KSTACK_SIZE +---------------------------------+
+ *               |          kernel stack           |
+ *               |                |                |
+ *               |                V                |
+ *               |         grows downward          |
+ *      2 * 4 kB +---------------------------------+
+ *               |   guard page (not present)      |
+ *          4 kB +---------------------------------+
+ *               |   FPU save area (threads/fpu.h) |
+ *               |                                 |
+ *               |          struct thread          |
+ *             0 +---------------------------------+
+ *
+ * Rounding the stack pointer down to KSTACK_SIZE still finds the
+ * running thread, and a stack that overflows faults on the guard
+ * page instead of silently overwriting the thread. */
+#define KSTACK_PAGES 4
+#define KSTACK_SIZE (KSTACK_PAGES * PGSIZE)
+
+void kstack_init (void);
+void *kstack_alloc (void);
+void kstack_free (void *);
+size_t kstack_used (const void *);
+void kstack_print_stats (void);
+
+#endif /* threads/kstack.h */
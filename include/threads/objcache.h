@@ -0,0 +1,48 @@
+#ifndef THREADS_OBJCACHE_H
+#define THREADS_OBJCACHE_H
+
+#include <stddef.h>
+#include "threads/synch.h"
+
+/* Object cache.
+ *
+ * Keeps a bounded pool of freed objects of one type so that they
+ * can be handed out again without going back to the underlying
+ * allocator or initializing them from scratch.  An object must be
+ * returned to the cache in the same state that the cache's
+ * allocation function produces, except that its first
+ * pointer-sized word is overwritten while it sits in the cache.
+ *
+ * The cache is protected by a spinlock, so objects may be freed
+ * with interrupts off, for example while reaping a dying thread in
+ * the scheduler. */
+
+/* Allocates and initializes a new object, or returns a null
+   pointer if memory is exhausted. */
+typedef void *objcache_alloc_func (void);
+
+/* Frees an object that the cache has no room for. */
+typedef void objcache_free_func (void *);
+
+struct objcache {
+	const char *name;               /* Name, for statistics. */
+	size_t max_cnt;                 /* Maximum number of cached objects. */
+	objcache_alloc_func *alloc;     /* Underlying allocator. */
+	objcache_free_func *free;       /* Underlying deallocator. */
+
+	struct spinlock lock;           /* Protects the members below. */
+	struct objcache_link *objs;     /* Cached objects. */
+	size_t cnt;                     /* Number of cached objects. */
+
+	/* Statistics. */
+	long long get_cnt;              /* # of objects handed out. */
+	long long hit_cnt;              /* # of those taken from the cache. */
+};
+
+void objcache_init (struct objcache *, const char *name, size_t max_cnt,
+		objcache_alloc_func *, objcache_free_func *);
+void *objcache_get (struct objcache *);
+void objcache_put (struct objcache *, void *);
+void objcache_print_stats (struct objcache *);
+
+#endif /* threads/objcache.h */
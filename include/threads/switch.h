@@ -0,0 +1,40 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+/* Kernel-to-kernel context switch.
+ *
+ * A thread only ever gives up the CPU from inside schedule(), in
+ * kernel mode with interrupts off, so everything the C calling
+ * convention lets a callee clobber is already dead at that point.
+ * switch_threads() therefore saves just the callee-saved
+ * registers, on the outgoing thread's own stack, records that
+ * thread's stack pointer, and pops the incoming thread's
+ * registers off its stack.  A user context, when there is one,
+ * lives in the intr_frame at the top of the thread's kernel stack
+ * and is restored by the normal interrupt return path. */
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+/* switch_threads()'s stack frame, lowest address first. */
+struct switch_threads_frame {
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rbp;
+	uint64_t rbx;
+	void (*rip) (void);         /* Return address. */
+};
+
+/* Saves the current thread's registers on its stack, stores its
+   stack pointer into *CUR_RSP, and resumes the thread whose saved
+   stack pointer is NEXT_RSP. */
+void switch_threads (uint64_t *cur_rsp, uint64_t next_rsp);
+
+/* Where a new thread's first switch_threads() returns to.  Calls
+   the function in %rbx with %r12 and %r13 as its arguments. */
+void switch_entry (void);
+#endif
+
+#endif /* threads/switch.h */
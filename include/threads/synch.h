@@ -2,50 +2,195 @@
 #define THREADS_SYNCH_H
 
 #include <list.h>
+#include <lockstat.h>
+#include <rbtree.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
 
-/* A counting semaphore. */
+struct thread;
+
+/* A counting semaphore.
+
+   Its waiters are kept in a tree ordered by effective priority,
+   highest first, and waiters of equal priority in the order they
+   began to wait, so sema_up() finds the thread to wake in
+   constant time.  A waiter whose priority changes through
+   donation is moved to its new place at once (see
+   synch_unqueue()). */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct rbtree waiters;      /* Waiting threads, highest priority first. */
 };
 
-/* One semaphore in a list. */
+/* A thread waiting on a condition variable. */
 struct semaphore_elem {
-	struct list_elem elem;              /* List element. */
+	struct rbtree_elem elem;            /* Element in cond->waiters. */
 	struct semaphore semaphore;         /* This semaphore. */
+	struct condition *cond;             /* Condition variable waited on. */
+	struct thread *thread;              /* Waiting thread. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
+bool sema_down_timeout (struct semaphore *, int64_t ticks);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
 
-/* Lock. */
+/* Lock.
+
+   While a thread waits for a lock, its priority is donated to the
+   lock's holder, and onward through whatever lock the holder is
+   itself waiting for.  The members below the semaphore belong to
+   the donation code in thread.c.
+
+   A lock named with lock_set_name() also keeps contention
+   statistics, which lock_print_stats() and the lockstat() system
+   call report. */
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	struct rbtree waiters;      /* Waiting threads, highest priority first. */
+	struct rbtree_elem holder_elem; /* Element in holder's `held_locks'. */
+	int priority;               /* Priority of first waiter, or -1. */
+	struct lockstat *stats;     /* Statistics, or null if unnamed. */
+	uint64_t acquired_at;       /* When acquired, if STATS is nonnull. */
 };
 
 void lock_init (struct lock *);
+void lock_set_name (struct lock *, const char *name);
 void lock_acquire (struct lock *);
+bool lock_acquire_timeout (struct lock *, int64_t ticks);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+size_t lock_stats_top (struct lockstat *, size_t cnt);
+void lock_print_stats (void);
+
+/* Readers-writer lock.
+
+   Any number of readers may hold it at once, or else one writer.
+   Writers are preferred: once a writer is waiting, readers that
+   arrive wait behind it, so a stream of readers cannot starve
+   writers.
 
-/* Condition variable. */
+   A writer holds the lock inside it for as long as it holds the
+   rwlock, so threads waiting to read or write donate their
+   priority to the writer just as they would to a lock's holder.
+   Each reader records its hold in a struct rwlock_hold, and a
+   writer waiting for the readers to leave donates its priority to
+   all of them through their holds.  The donation code in thread.c
+   owns the holds and the `readers_held' list. */
+struct rwlock {
+	struct lock lock;           /* Held by a writer, or briefly by a
+	                               thread starting to read. */
+	unsigned readers;           /* Number of readers holding it. */
+	bool writer_waiting;        /* Writer waiting for readers to leave? */
+	struct semaphore drained;   /* Up'd for it by the last reader. */
+	struct list readers_held;   /* Readers' holds. */
+};
+
+/* A thread's hold on a readers-writer lock for reading, one of a
+   few in struct thread.  A thread that reads more rwlocks at once
+   than it has holds for still gets in, but is not donated to
+   through the extra ones. */
+struct rwlock_hold {
+	struct rwlock *rw;          /* Lock held for reading, or null. */
+	struct thread *holder;      /* Thread this hold belongs to. */
+	unsigned depth;             /* Times RW is held by HOLDER. */
+	int priority;               /* Donated by a waiting writer. */
+	struct list_elem rw_elem;   /* Element in RW's readers_held. */
+	struct rbtree_elem holder_elem; /* Element in holder's read_holds. */
+};
+
+void rwlock_init (struct rwlock *);
+void rwlock_set_name (struct rwlock *, const char *name);
+void rwlock_read_acquire (struct rwlock *);
+bool rwlock_read_acquire_timeout (struct rwlock *, int64_t ticks);
+void rwlock_read_release (struct rwlock *);
+void rwlock_write_acquire (struct rwlock *);
+bool rwlock_write_acquire_timeout (struct rwlock *, int64_t ticks);
+void rwlock_write_release (struct rwlock *);
+bool rwlock_write_held (const struct rwlock *);
+
+/* Condition variable.  Like a semaphore's, its waiters are kept
+   in priority order. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct rbtree waiters;      /* struct semaphore_elems, highest
+	                               priority first. */
 };
 
 void cond_init (struct condition *);
 void cond_wait (struct condition *, struct lock *);
+bool cond_wait_timeout (struct condition *, struct lock *, int64_t ticks);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
-// * Semaphore 추가 함수
-bool cmp_sem_priority(const struct list_elem *a, const struct list_elem *b, void *aux);
+/* Spinlock.
+
+   Protects short critical sections that may not sleep, such as a
+   run queue, against interrupt handlers on the local CPU and
+   against other CPUs.  Acquiring a spinlock disables interrupts
+   until it is released, so on a uniprocessor it costs no more than
+   intr_disable().  Spinlocks do not nest across CPUs in any
+   particular order, so never hold two at once.
+
+   A spinlock is a ticket lock: each CPU that wants it takes the
+   next ticket and waits for its number to come up, so CPUs get it
+   in the order they asked, and one CPU cannot keep winning the
+   race for it while another starves. */
+struct spinlock {
+	volatile uint32_t next;     /* Next ticket to hand out. */
+	volatile uint32_t owner;    /* Ticket now allowed to hold it. */
+	enum intr_level old_level;  /* Interrupt level before acquiring. */
+};
+
+void spinlock_init (struct spinlock *);
+void spinlock_acquire (struct spinlock *);
+void spinlock_release (struct spinlock *);
+bool spinlock_held (const struct spinlock *);
+
+/* Sequence lock.
+
+   Protects data that is read far more often than it is written,
+   such as a counter advanced by the timer interrupt, without
+   making readers lock anything or turn off interrupts.  A writer
+   makes the sequence number odd before changing the data and even
+   again afterward.  A reader notes the number, copies the data,
+   and tries again if the number was odd or has since changed.
+   So a writer, typically an interrupt handler, never waits for a
+   reader, and readers never delay it.
+
+   Writers must already exclude one another, for example by all
+   running in one CPU's timer interrupt, and must have interrupts
+   off, so that a reader on their own CPU cannot interrupt them
+   and then wait forever for the number to become even.  A reader
+   may see a torn copy of the data before it retries, so it should
+   do nothing with the data but copy it out.
+
+   Usage:
+
+       uint32_t seq;
+
+       do {
+               seq = seqlock_read_begin (&lock);
+               copy = data;
+       } while (seqlock_read_retry (&lock, seq)); */
+struct seqlock {
+	volatile uint32_t seq;      /* Odd while being written. */
+};
+
+void seqlock_init (struct seqlock *);
+void seqlock_write_begin (struct seqlock *);
+void seqlock_write_end (struct seqlock *);
+uint32_t seqlock_read_begin (const struct seqlock *);
+bool seqlock_read_retry (const struct seqlock *, uint32_t seq);
+
+/* For thread.c, around a change to a thread's priority. */
+void synch_unqueue (struct thread *);
+void synch_requeue (struct thread *);
 
 /* Optimization barrier.
  *
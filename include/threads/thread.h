@@ -7,6 +7,9 @@
 #include <limits.h>
 #include "threads/interrupt.h"
 #include <hash.h> /* pintos project3 */
+#include <wheel.h>
+#include <rbtree.h>
+#include <schedstat.h>
 #ifdef VM
 #include "vm/vm.h"
 #endif
@@ -33,7 +36,27 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Thread nice values. */
+#define NICE_MIN -20                    /* Nicest. */
+#define NICE_DEFAULT 0                  /* Default nice value. */
+#define NICE_MAX 20                     /* Least nice. */
+
+/* Most readers-writer locks a thread holds for reading at once
+   that can donate to it. */
+#define THREAD_RW_HOLDS 4
+
+/* A thread's entry in the tid table, keyed by a copy of its tid,
+   so that a lookup needs only a key of this size. */
+struct tid_entry {
+	tid_t tid;                          /* Same as the thread's. */
+	struct hash_elem elem;              /* Element in the tid table. */
+};
+
 /* A kernel thread or user process.
+ *
+ * The description below is of the initial thread.  Every other
+ * thread gets a multi-page kernel stack with a guard page between
+ * the stack and the thread structure; see threads/kstack.h.
  *
  * Each thread structure is stored in its own 4 kB page.  The
  * thread structure itself sits at the very bottom of the page
@@ -83,33 +106,74 @@ typedef int tid_t;
  * an assertion failure in thread_current(), which checks that
  * the `magic' member of the running thread's `struct thread' is
  * set to THREAD_MAGIC.  Stack overflow will normally change this
- * value, triggering the assertion. */
-/* The `elem' member has a dual purpose.  It can be an element in
- * the run queue (thread.c), or it can be an element in a
- * semaphore wait list (synch.c).  It can be used these two ways
- * only because they are mutually exclusive: only a thread in the
- * ready state is on the run queue, whereas only a thread in the
- * blocked state is on a semaphore wait list. */
+ * value, triggering the assertion.
+ *
+ * The `elem' member is an element in the run queue (thread.c).
+ * A thread waiting for a semaphore is instead in the semaphore's
+ * waiters through `sema_elem' (synch.c), which is kept separate
+ * because a waiter's place there changes with its priority. */
 struct thread {
 	/* Owned by thread.c. */
 	tid_t tid;                          /* Thread identifier. */
 	enum thread_status status;          /* Thread state. */
 	char name[16];                      /* Name (for debugging purposes). */
 	int priority;                       /* Priority. */
-	int wakeup_tick;					/* Wake up tick */
+	struct wheel_elem sleep_elem;		/* Sleep wheel element; expires is the wake up tick */
 	int init_priority;					/* initial priority before priority donation */
 
   // * priority schedule 추가
 	struct lock *wait_on_lock;			/* lock, thread waiting for */
-	struct list donations;				/* list for multi donation */
-	struct list_elem donation_elem;		/* list_elem for donation list */
+	struct rbtree held_locks;           /* Locks held, by donated priority. */
+	struct rbtree_elem donor_elem;      /* Element in wait_on_lock's waiters. */
+	struct rwlock *wait_on_readers;     /* Rwlock whose readers we wait
+	                                       to leave, or null. */
+	struct rbtree read_holds;           /* Holds in use, by donated priority. */
+	struct rwlock_hold rw_holds[THREAD_RW_HOLDS]; /* Read holds. */
+
+	/* Owned by synch.c. */
+	struct semaphore *wait_on_sema;     /* Semaphore waiting for, or null. */
+	struct rbtree_elem sema_elem;       /* Element in its waiters. */
+	struct semaphore_elem *cond_waiter; /* Condition variable wait, or null. */
 
   // * Advanced Scheduler 구현 추가
   int nice;
   int recent_cpu;
+  int64_t decay_epoch;                /* Last decay applied to recent_cpu. */
+	struct list_elem blocked_elem;      /* blocked_list element. */
+	bool on_blocked_list;               /* In blocked_list? */
+
+	/* Owned by thread.c, for the fair-share scheduler. */
+	int64_t vruntime;                   /* Weighted CPU time received. */
+	struct rbtree_elem fair_elem;       /* Run queue element. */
+
+	/* Owned by thread.c, for scheduling statistics. */
+	struct sched_stats sched;           /* See lib/schedstat.h. */
+	struct seqlock sched_seq;           /* Guards `sched'. */
+	int64_t ready_since;                /* When it last became ready. */
+	bool woken;                         /* Unblocked and not yet run? */
+
+	/* Owned by thread.c, for the EDF real-time class.  A thread
+	   is real-time if edf_runtime is nonzero.  Times in ticks. */
+	int64_t edf_runtime;                /* Runtime per period. */
+	int64_t edf_deadline;               /* Deadline, relative to period. */
+	int64_t edf_period;                 /* Period. */
+	int64_t edf_budget;                 /* Runtime left in this period. */
+	int64_t edf_abs_deadline;           /* Deadline it is scheduled by. */
+	int64_t edf_job_deadline;           /* Deadline of its current job. */
+	int64_t edf_next_period;            /* Start of its next period. */
+	bool edf_throttled;                 /* Out of runtime? */
+	struct rbtree_elem edf_elem;        /* Run queue element. */
+
+	/* Owned by threads/fpu.c. */
+	bool fpu_used;                      /* Has FPU state worth keeping? */
+	void *fpu_area;                     /* FXSAVE area, or null. */
+
+	/* Owned by thread.c. */
+	struct tid_entry tid_entry;         /* Entry in the tid table. */
 
-	/* Shared between thread.c and synch.c. */
+	/* Owned by thread.c. */
 	struct list_elem elem;              /* List element. */
+	struct cpu *cpu;                    /* CPU whose run queue it was last on. */
 
   // * USERPROG 추가 
   int exit_status; /* 프로세스의 종료 상태를 확인하는 필드 추가 */
@@ -118,15 +182,15 @@ struct thread {
   struct semaphore fork_sema;
 
   struct list children;
-  struct list_elem child_elem;
+  struct list_elem child_elem;        /* In parent's children, or, for a
+                                         thread started by uthread_create(),
+                                         in its process's threads. */
 
   struct thread *parent; /* 부모 프로세스 디스크립터를 가리키는 필드 추가 */
 
-  struct file **fdt;
+  struct file **fdt;                  /* Shared by a process's threads. */
   int next_fd;
 
-  struct file *run_file;
-
   /* pintos project3 */
   uintptr_t rsp;
   uint64_t stack_bottom;
@@ -135,16 +199,19 @@ struct thread {
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4; /* Page map level 4 == pagedir(32bit) */
+	struct process *process;            /* User process, or null. */
+	int stack_slot;                     /* User stack slot, 0 for the
+	                                       process's main thread. */
 #endif
 #ifdef VM
-	/* Table for whole virtual memory owned by thread.
-	 * 스레드가 소유한 전체 가상 메모리에 대한 테이블입니다. */
-	struct supplemental_page_table spt;
+	/* Table for whole virtual memory owned by the thread's process.
+	 * 스레드의 프로세스가 소유한 전체 가상 메모리에 대한 테이블입니다. */
+	struct supplemental_page_table *spt;
 #endif
 
 	/* Owned by thread.c. */
   struct intr_frame ptf;
-	struct intr_frame tf;               /* Information for switching */
+	uint64_t ksp;                       /* Saved stack pointer, for switching. */
 	unsigned magic;                     /* Detects stack overflow. */
 };
 
@@ -153,11 +220,26 @@ struct thread {
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If false (default), the run queue is one FIFO per priority.
+   If true, it is a single list kept ordered by priority.
+   Controlled by kernel command-line option "-ready-list". */
+extern bool thread_ready_list;
+
+/* If true, use the fair-share scheduler instead of priorities.
+   Controlled by kernel command-line option "-fair". */
+extern bool thread_fair;
+
 void thread_init (void);
 void thread_start (void);
 
 void thread_tick (void);
+void thread_tick_idle (int64_t cnt);
 void thread_print_stats (void);
+size_t thread_stack_used (void);
+void thread_sched_stats (struct thread *, struct sched_stats *);
+
+struct file **fdt_alloc (void);
+void fdt_free (struct file **);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -166,12 +248,17 @@ void thread_block (void);
 void thread_unblock (struct thread *);
 
 struct thread *thread_current (void);
+struct thread *thread_lookup_child (tid_t);
 tid_t thread_tid (void);
 const char *thread_name (void);
 
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
 
+bool thread_set_deadline (int64_t runtime, int64_t deadline,
+		int64_t period);
+void thread_deadline_yield (void);
+
 void thread_sleep(int64_t ticks);
 void thread_awake(int64_t ticks);
 void update_next_tick_to_awake(int64_t ticks);
@@ -192,9 +279,15 @@ void test_max_priority (void);
 bool cmp_priority (const struct list_elem *a, const struct list_elem *b, void *aux UNUSED);
 
 // * priority donation 추가 함수
-void donate_priority(void);
-void remove_with_lock(struct lock *lock);
-void refresh_priority(void);
+void donation_init (struct lock *);
+void donation_wait (struct lock *);
+void donation_acquire (struct lock *);
+void donation_cancel (struct lock *);
+void donation_release (struct lock *);
+void donation_read_acquire (struct rwlock *);
+void donation_read_release (struct rwlock *);
+void donation_readers_wait (struct rwlock *);
+void donation_readers_done (struct rwlock *);
 
 // * 스케줄러를 위해 추가로 구현할 함수 선언
 void mlfqs_priority(struct thread *t);
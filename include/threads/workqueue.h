@@ -0,0 +1,100 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Work queues.
+ *
+ * A work queue runs functions ("work items") on a small pool of
+ * kernel threads of its own, so that code that must not sleep or
+ * must finish quickly, such as an interrupt handler or a system
+ * call holding a lock, can hand longer work off.  Queuing an item
+ * never sleeps and may be done from an interrupt handler.
+ *
+ * Each queue's workers run at the priority given when the queue
+ * is created, so urgent work can go to a queue of its own that
+ * preempts ordinary threads, and background work to one that
+ * does not.  A worker takes up to WORK_BATCH_MAX items at a time
+ * from the queue, so a burst of queued items costs one wakeup and
+ * one trip through the queue's lock, not one per item.
+ *
+ * Like the kernel containers, work queues do no allocation per
+ * item: the caller embeds a struct work in its own structure and
+ * uses work_entry() to get back to it from the work function.  An
+ * item may be queued again, even by its own work function, once it
+ * has started to run.  Until then it counts as pending, even after
+ * a worker has taken it in a batch. */
+
+/* Maximum number of worker threads per queue. */
+#define WORKQUEUE_MAX_WORKERS 4
+
+/* Maximum number of items a worker takes off the queue at once. */
+#define WORK_BATCH_MAX 16
+
+struct work;
+
+/* Performs work item W.  Runs in a worker thread, so it may
+   sleep. */
+typedef void work_func (struct work *w);
+
+/* Work item. */
+struct work {
+	struct list_elem elem;          /* Element in a queue's pending list. */
+	work_func *func;                /* Function to run. */
+	struct workqueue *wq;           /* Queue pending on, or null. */
+	int64_t seq;                    /* Position in queue order. */
+};
+
+/* Converts pointer to work item WORK into a pointer to the
+   structure that WORK is embedded inside.  Supply the name of the
+   outer structure STRUCT and the member name MEMBER of the work
+   item. */
+#define work_entry(WORK, STRUCT, MEMBER)                        \
+	((STRUCT *) ((uint8_t *) (WORK) - offsetof (STRUCT, MEMBER)))
+
+/* One worker thread. */
+struct worker {
+	struct workqueue *wq;           /* Queue it works for. */
+	tid_t tid;                      /* Its thread. */
+	struct semaphore wake;          /* Up'd to wake it when idle. */
+	struct list_elem idle_elem;     /* Element in wq->idle. */
+	int64_t active_seq;             /* Lowest seq it has yet to finish,
+	                                   INT64_MAX if none. */
+};
+
+/* Work queue. */
+struct workqueue {
+	const char *name;               /* Name, for threads and statistics. */
+	size_t worker_cnt;              /* Number of workers. */
+	struct worker workers[WORKQUEUE_MAX_WORKERS];
+
+	struct spinlock lock;           /* Protects the members below. */
+	struct list pending;            /* Queued items, in seq order. */
+	struct list idle;               /* Workers waiting for items. */
+	struct list flushers;           /* Threads in workqueue_flush(). */
+	int64_t next_seq;               /* Next item's seq. */
+
+	/* Statistics. */
+	long long queue_cnt;            /* # of items queued. */
+	long long batch_cnt;            /* # of batches run. */
+	size_t max_batch;               /* Largest batch run. */
+};
+
+/* Queue for work that has no reason to have a queue of its own. */
+extern struct workqueue system_wq;
+
+void workqueue_init (struct workqueue *, const char *name, int priority,
+		size_t worker_cnt);
+void work_init (struct work *, work_func *);
+bool workqueue_queue (struct workqueue *, struct work *);
+bool workqueue_cancel (struct work *);
+void workqueue_flush (struct workqueue *);
+bool work_pending (const struct work *);
+void workqueue_print_stats (struct workqueue *);
+
+#endif /* threads/workqueue.h */
@@ -1,17 +1,78 @@
 #ifndef USERPROG_PROCESS_H
 #define USERPROG_PROCESS_H
 
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/synch.h"
 #include "threads/thread.h"
 
+/* Most threads a process may have at once, its main thread
+   included. */
+#define PROCESS_THREAD_MAX 16
+
+/* Pages of user stack given to each thread started by
+   uthread_create().  These stacks do not grow. */
+#define THREAD_STACK_PAGES 4
+
+/* How often, in timer ticks, a thread waiting for something that
+   its process's exit does not wake checks whether the process is
+   exiting. */
+#define PROCESS_POLL_TICKS 5
+
+/* What the threads of a user process share.
+
+   A process starts with one thread, its main thread, whose tid is
+   the process's pid, and may start more with uthread_create().
+   All of them run in the same page map and use the same file
+   descriptor table, which each thread's pml4 and fdt members
+   point to, and the same supplemental page table.  Each thread
+   holds a reference to its process, and the last one to exit
+   closes the files and destroys the address space.
+
+   A process ends when its main thread does, or when any of its
+   threads calls exit().  Its other threads then exit on their way
+   back to user mode, from a system call or an interrupt.  Those
+   sleeping in futex_wait() are woken to do so, and those waiting
+   in uthread_join(), wait() or a console read() give up within
+   PROCESS_POLL_TICKS. */
+struct process {
+	struct lock lock;               /* Protects the members below. */
+	int ref_cnt;                    /* Threads using it. */
+	struct list threads;            /* Threads not yet joined, other
+	                                   than the main thread. */
+	uint32_t stack_slots;           /* Bitmap of user stacks in use. */
+	bool exiting;                   /* Has exit() been called? */
+	int exit_status;                /* Status given to exit(). */
+
+	struct file *run_file;          /* Executable, denied writes. */
+
+	/* Serializes filling and clearing the slots of the shared fd
+	   table.  A slot is cleared only while filesys_lock is also
+	   held for writing, so a thread that holds filesys_lock in
+	   either mode may use the file it finds in a slot until it
+	   lets go. */
+	struct lock fd_lock;
+#ifdef VM
+	struct supplemental_page_table spt;
+#endif
+};
+
 tid_t process_create_initd (const char *file_name);
 tid_t process_fork (const char *name, struct intr_frame *if_);
 int process_exec (void *f_name);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (struct thread *next);
+void process_terminate (int status);
+bool process_exiting (void);
+bool process_sema_down (struct semaphore *);
+
+tid_t process_thread_create (uintptr_t entry, uint64_t arg0, uint64_t arg1);
+int process_thread_join (tid_t);
 
 void argument_stack(char **parse, int count, void **esp);
 struct thread *get_child_process(int pid);
 void remove_child_process(struct thread *cp);
 
-#endif /* userprog/process.h */
\ No newline at end of file
+#endif /* userprog/process.h */
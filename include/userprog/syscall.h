@@ -1,11 +1,14 @@
 // * USERPROG 추가
 #include <stdbool.h>
 #include "threads/thread.h"
+#include <clock.h>
 
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
-struct lock filesys_lock;
+/* Serializes file system access by system calls.  Reads share it;
+   anything else takes it for writing. */
+extern struct rwlock filesys_lock;
 
 void syscall_init (void);
 
@@ -27,6 +30,13 @@ int write(int fd, const void *buffer, unsigned size);
 void seek (int fd, unsigned position);
 unsigned tell (int fd);
 void close (int fd);
+bool schedstat (int pid, struct sched_stats *stats);
+int futex (int *uaddr, int op, int val);
+int lockstat (struct lockstat *stats, int cnt);
+tid_t uthread_create (void *entry, void *func, void *aux);
+void uthread_exit (int status);
+int uthread_join (tid_t tid);
+int clock_gettime (int clock, struct timespec *ts);
 
 /* pintos project3 */
 void check_valid_string (const void *str, unsigned size);
@@ -6,6 +6,7 @@
 /* pintos project3 */
 #include <hash.h>
 #include <./threads/mmu.h>
+#include "threads/synch.h"
 
 enum vm_type {
 	/* page not initialized */
@@ -114,6 +115,9 @@ struct page_operations {
 struct supplemental_page_table {
 	/* pintos project3 */
 	struct hash hash;
+	struct rwlock lock;     /* The threads of a process share it; lookups
+	                           take this for reading, insertions for
+	                           writing. */
 };
 
 #include "threads/thread.h"
@@ -0,0 +1,320 @@
+/* Red-black tree.
+
+   See rbtree.h for basic information.  The algorithms are those
+   of [CLRS] chapter 13, adapted to use null pointers instead of a
+   sentinel leaf, so that a tree needs no storage outside its
+   elements. */
+
+#include "rbtree.h"
+#include "../debug.h"
+
+static bool is_red (const struct rbtree_elem *);
+static void rotate_left (struct rbtree *, struct rbtree_elem *);
+static void rotate_right (struct rbtree *, struct rbtree_elem *);
+static void replace_child (struct rbtree *, struct rbtree_elem *parent,
+		struct rbtree_elem *old, struct rbtree_elem *new);
+static void insert_fixup (struct rbtree *, struct rbtree_elem *);
+static void remove_fixup (struct rbtree *, struct rbtree_elem *,
+		struct rbtree_elem *parent);
+
+/* Initializes T as an empty tree ordered by LESS given auxiliary
+   data AUX. */
+void
+rbtree_init (struct rbtree *t, rbtree_less_func *less, void *aux) {
+	ASSERT (t != NULL);
+	ASSERT (less != NULL);
+
+	t->root = NULL;
+	t->min = NULL;
+	t->elem_cnt = 0;
+	t->less = less;
+	t->aux = aux;
+}
+
+/* Inserts E into T, after any elements equal to it. */
+void
+rbtree_insert (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *parent = NULL;
+	struct rbtree_elem **link = &t->root;
+	bool leftmost = true;
+
+	ASSERT (t != NULL);
+	ASSERT (e != NULL);
+
+	while (*link != NULL) {
+		parent = *link;
+		if (t->less (e, parent, t->aux))
+			link = &parent->left;
+		else {
+			link = &parent->right;
+			leftmost = false;
+		}
+	}
+
+	e->parent = parent;
+	e->left = e->right = NULL;
+	e->red = true;
+	*link = e;
+	if (leftmost)
+		t->min = e;
+	t->elem_cnt++;
+
+	insert_fixup (t, e);
+}
+
+/* Removes E, which must be in T, from T. */
+void
+rbtree_remove (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *child, *parent;
+	bool removed_red;
+
+	ASSERT (t != NULL);
+	ASSERT (e != NULL);
+	ASSERT (t->elem_cnt > 0);
+
+	if (t->min == e)
+		t->min = rbtree_next (e);
+	t->elem_cnt--;
+
+	if (e->left == NULL || e->right == NULL) {
+		/* E has at most one child, which takes its place. */
+		child = e->left != NULL ? e->left : e->right;
+		parent = e->parent;
+		removed_red = e->red;
+		replace_child (t, parent, e, child);
+		if (child != NULL)
+			child->parent = parent;
+	} else {
+		/* E's successor S has no left child.  S takes E's place,
+		   and S's right child takes S's place. */
+		struct rbtree_elem *s = e->right;
+		while (s->left != NULL)
+			s = s->left;
+
+		child = s->right;
+		removed_red = s->red;
+		if (s->parent == e)
+			parent = s;
+		else {
+			parent = s->parent;
+			parent->left = child;
+			if (child != NULL)
+				child->parent = parent;
+			s->right = e->right;
+			s->right->parent = s;
+		}
+		s->left = e->left;
+		s->left->parent = s;
+		s->red = e->red;
+		s->parent = e->parent;
+		replace_child (t, e->parent, e, s);
+	}
+
+	if (!removed_red)
+		remove_fixup (t, child, parent);
+}
+
+/* Returns the smallest element in T, or a null pointer if T is
+   empty.  Runs in constant time. */
+struct rbtree_elem *
+rbtree_min (struct rbtree *t) {
+	return t->min;
+}
+
+/* Returns the largest element in T, or a null pointer if T is
+   empty. */
+struct rbtree_elem *
+rbtree_max (struct rbtree *t) {
+	struct rbtree_elem *e = t->root;
+
+	if (e != NULL)
+		while (e->right != NULL)
+			e = e->right;
+	return e;
+}
+
+/* Returns the element that follows E in its tree, or a null
+   pointer if E is the largest. */
+struct rbtree_elem *
+rbtree_next (struct rbtree_elem *e) {
+	ASSERT (e != NULL);
+
+	if (e->right != NULL) {
+		e = e->right;
+		while (e->left != NULL)
+			e = e->left;
+		return e;
+	}
+	while (e->parent != NULL && e == e->parent->right)
+		e = e->parent;
+	return e->parent;
+}
+
+/* Returns the number of elements in T. */
+size_t
+rbtree_size (struct rbtree *t) {
+	return t->elem_cnt;
+}
+
+/* Returns true if T contains no elements, false otherwise. */
+bool
+rbtree_empty (struct rbtree *t) {
+	return t->elem_cnt == 0;
+}
+
+/* Returns true if E is red.  Null leaves are black. */
+static bool
+is_red (const struct rbtree_elem *e) {
+	return e != NULL && e->red;
+}
+
+/* Makes NEW take the place of OLD as the child of PARENT in T, or
+   as T's root if PARENT is null.  Does not update NEW's parent
+   pointer. */
+static void
+replace_child (struct rbtree *t, struct rbtree_elem *parent,
+		struct rbtree_elem *old, struct rbtree_elem *new) {
+	if (parent == NULL)
+		t->root = new;
+	else if (parent->left == old)
+		parent->left = new;
+	else
+		parent->right = new;
+}
+
+/* Rotates the subtree rooted at E to the left, so that E's right
+   child takes E's place and E becomes its left child. */
+static void
+rotate_left (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *r = e->right;
+
+	e->right = r->left;
+	if (r->left != NULL)
+		r->left->parent = e;
+	r->parent = e->parent;
+	replace_child (t, e->parent, e, r);
+	r->left = e;
+	e->parent = r;
+}
+
+/* Rotates the subtree rooted at E to the right, so that E's left
+   child takes E's place and E becomes its right child. */
+static void
+rotate_right (struct rbtree *t, struct rbtree_elem *e) {
+	struct rbtree_elem *l = e->left;
+
+	e->left = l->right;
+	if (l->right != NULL)
+		l->right->parent = e;
+	l->parent = e->parent;
+	replace_child (t, e->parent, e, l);
+	l->right = e;
+	e->parent = l;
+}
+
+/* Restores the red-black properties after red element E has been
+   inserted into T. */
+static void
+insert_fixup (struct rbtree *t, struct rbtree_elem *e) {
+	while (is_red (e->parent)) {
+		struct rbtree_elem *parent = e->parent;
+		struct rbtree_elem *grandparent = parent->parent;
+
+		if (parent == grandparent->left) {
+			struct rbtree_elem *uncle = grandparent->right;
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grandparent->red = true;
+				e = grandparent;
+				continue;
+			}
+			if (e == parent->right) {
+				rotate_left (t, parent);
+				e = parent;
+				parent = e->parent;
+			}
+			parent->red = false;
+			grandparent->red = true;
+			rotate_right (t, grandparent);
+		} else {
+			struct rbtree_elem *uncle = grandparent->left;
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grandparent->red = true;
+				e = grandparent;
+				continue;
+			}
+			if (e == parent->left) {
+				rotate_right (t, parent);
+				e = parent;
+				parent = e->parent;
+			}
+			parent->red = false;
+			grandparent->red = true;
+			rotate_left (t, grandparent);
+		}
+	}
+	t->root->red = false;
+}
+
+/* Restores the red-black properties after a black element has
+   been removed from T.  E, possibly null, is the element that
+   took its place, and PARENT is E's parent. */
+static void
+remove_fixup (struct rbtree *t, struct rbtree_elem *e,
+		struct rbtree_elem *parent) {
+	while (e != t->root && !is_red (e)) {
+		if (e == parent->left) {
+			struct rbtree_elem *sibling = parent->right;
+			if (is_red (sibling)) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_left (t, parent);
+				sibling = parent->right;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				e = parent;
+				parent = e->parent;
+				continue;
+			}
+			if (!is_red (sibling->right)) {
+				sibling->left->red = false;
+				sibling->red = true;
+				rotate_right (t, sibling);
+				sibling = parent->right;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->right->red = false;
+			rotate_left (t, parent);
+		} else {
+			struct rbtree_elem *sibling = parent->left;
+			if (is_red (sibling)) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_right (t, parent);
+				sibling = parent->left;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				e = parent;
+				parent = e->parent;
+				continue;
+			}
+			if (!is_red (sibling->left)) {
+				sibling->right->red = false;
+				sibling->red = true;
+				rotate_left (t, sibling);
+				sibling = parent->left;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->left->red = false;
+			rotate_right (t, parent);
+		}
+		e = t->root;
+	}
+	if (e != NULL)
+		e->red = false;
+}
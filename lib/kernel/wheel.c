@@ -0,0 +1,231 @@
+/* Hierarchical timing wheel.
+
+   See wheel.h for basic information. */
+
+#include "wheel.h"
+#include "../debug.h"
+#include "intrinsic.h"
+
+#define list_elem_to_wheel_elem(LIST_ELEM)                      \
+	list_entry(LIST_ELEM, struct wheel_elem, list_elem)
+
+static unsigned level_of (const struct wheel *, int64_t expires);
+static unsigned slot_of (int64_t expires, unsigned level);
+static void place_elem (struct wheel *, struct wheel_elem *);
+static int64_t find_next (struct wheel *);
+static void advance (struct wheel *);
+
+/* Initializes W as an empty wheel whose clock reads CLOCK. */
+void
+wheel_init (struct wheel *w, int64_t clock) {
+	unsigned level, slot;
+
+	ASSERT (w != NULL);
+	ASSERT (clock >= 0);
+
+	w->clock = clock;
+	w->next = INT64_MAX;
+	w->elem_cnt = 0;
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		w->occupied[level] = 0;
+		for (slot = 0; slot < WHEEL_SLOTS; slot++)
+			list_init (&w->slots[level][slot]);
+	}
+	list_init (&w->due);
+}
+
+/* Inserts E into W to expire at tick EXPIRES.  If EXPIRES is not
+   after W's clock, E is due immediately. */
+void
+wheel_insert (struct wheel *w, struct wheel_elem *e, int64_t expires) {
+	ASSERT (w != NULL);
+	ASSERT (e != NULL);
+
+	e->expires = expires;
+	w->elem_cnt++;
+	if (expires <= w->clock) {
+		list_push_back (&w->due, &e->list_elem);
+		return;
+	}
+
+	place_elem (w, e);
+	if (expires < w->next)
+		w->next = expires;
+}
+
+/* Removes E, which must be in W, without waiting for it to
+   expire. */
+void
+wheel_remove (struct wheel *w, struct wheel_elem *e) {
+	ASSERT (w != NULL);
+	ASSERT (e != NULL);
+	ASSERT (w->elem_cnt > 0);
+
+	w->elem_cnt--;
+	list_remove (&e->list_elem);
+	if (e->expires > w->clock) {
+		unsigned level = level_of (w, e->expires);
+		unsigned slot = slot_of (e->expires, level);
+
+		if (list_empty (&w->slots[level][slot]))
+			w->occupied[level] &= ~(1ULL << slot);
+		if (e->expires == w->next)
+			w->next = find_next (w);
+	}
+}
+
+/* Removes and returns an element of W that expires at or before
+   tick NOW, or a null pointer if there is none.  Elements come out
+   in order of expiration time. */
+struct wheel_elem *
+wheel_pop_expired (struct wheel *w, int64_t now) {
+	ASSERT (w != NULL);
+
+	if (list_empty (&w->due) && w->next <= now)
+		advance (w);
+	if (list_empty (&w->due))
+		return NULL;
+
+	w->elem_cnt--;
+	return list_elem_to_wheel_elem (list_pop_front (&w->due));
+}
+
+/* Calls ACTION for each element in W, in no particular order,
+   passing AUX.  ACTION must not insert or remove elements. */
+void
+wheel_apply (struct wheel *w, wheel_action_func *action, void *aux) {
+	struct list_elem *e;
+	unsigned level, slot;
+
+	ASSERT (w != NULL);
+	ASSERT (action != NULL);
+
+	for (e = list_begin (&w->due); e != list_end (&w->due); e = list_next (e))
+		action (list_elem_to_wheel_elem (e), aux);
+	for (level = 0; level < WHEEL_LEVELS; level++)
+		for (slot = 0; slot < WHEEL_SLOTS; slot++) {
+			struct list *l = &w->slots[level][slot];
+
+			if (!(w->occupied[level] & (1ULL << slot)))
+				continue;
+			for (e = list_begin (l); e != list_end (l); e = list_next (e))
+				action (list_elem_to_wheel_elem (e), aux);
+		}
+}
+
+/* Returns the earliest expiration time of the elements in W, or
+   INT64_MAX if W is empty.  If some elements are already due,
+   returns W's clock, which is no later than their expiration. */
+int64_t
+wheel_next (struct wheel *w) {
+	return list_empty (&w->due) ? w->next : w->clock;
+}
+
+/* Returns the number of elements in W. */
+size_t
+wheel_size (struct wheel *w) {
+	return w->elem_cnt;
+}
+
+/* Returns true if W contains no elements, false otherwise. */
+bool
+wheel_empty (struct wheel *w) {
+	return w->elem_cnt == 0;
+}
+
+/* Returns the level at which an element expiring at EXPIRES
+   belongs, given W's current clock. */
+static unsigned
+level_of (const struct wheel *w, int64_t expires) {
+	uint64_t diff = (uint64_t) (expires ^ w->clock);
+
+	return diff == 0 ? 0 : bsrq (diff) / WHEEL_BITS;
+}
+
+/* Returns the slot within LEVEL for EXPIRES. */
+static unsigned
+slot_of (int64_t expires, unsigned level) {
+	return ((uint64_t) expires >> (level * WHEEL_BITS)) & (WHEEL_SLOTS - 1);
+}
+
+/* Puts E into the slot for its expiration time. */
+static void
+place_elem (struct wheel *w, struct wheel_elem *e) {
+	unsigned level = level_of (w, e->expires);
+	unsigned slot = slot_of (e->expires, level);
+
+	list_push_back (&w->slots[level][slot], &e->list_elem);
+	w->occupied[level] |= 1ULL << slot;
+}
+
+/* Returns the earliest expiration time among the elements in
+   W's slots, or INT64_MAX if the slots are empty.
+
+   Every element at a level shares the clock's digits above that
+   level and has a larger digit at that level, so the lowest
+   occupied slot of the lowest occupied level holds the earliest
+   element.  At level 0 a slot is exactly one tick; above that the
+   slot is scanned, which costs no more than cascading it will. */
+static int64_t
+find_next (struct wheel *w) {
+	unsigned level;
+
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		struct list *l;
+		struct list_elem *e;
+		unsigned slot;
+		int64_t min;
+
+		if (w->occupied[level] == 0)
+			continue;
+		slot = bsfq (w->occupied[level]);
+		if (level == 0)
+			return (w->clock & ~(int64_t) (WHEEL_SLOTS - 1)) | slot;
+
+		l = &w->slots[level][slot];
+		min = INT64_MAX;
+		for (e = list_begin (l); e != list_end (l); e = list_next (e)) {
+			int64_t expires = list_elem_to_wheel_elem (e)->expires;
+			if (expires < min)
+				min = expires;
+		}
+		return min;
+	}
+	return INT64_MAX;
+}
+
+/* Moves W's clock forward to its earliest expiration time and
+   moves the elements expiring then onto the due list.
+
+   Since nothing expires between the old clock and the new one,
+   an element keeps its level unless its digit at that level now
+   equals the clock's, and only that one slot per level has to be
+   cascaded.  Going from the top level down lets elements fall
+   through several levels in one pass. */
+static void
+advance (struct wheel *w) {
+	struct list *l;
+	unsigned level, slot;
+
+	ASSERT (w->next != INT64_MAX);
+
+	w->clock = w->next;
+	for (level = WHEEL_LEVELS - 1; level > 0; level--) {
+		slot = slot_of (w->clock, level);
+		if (!(w->occupied[level] & (1ULL << slot)))
+			continue;
+
+		l = &w->slots[level][slot];
+		w->occupied[level] &= ~(1ULL << slot);
+		while (!list_empty (l))
+			place_elem (w, list_elem_to_wheel_elem (list_pop_front (l)));
+	}
+
+	slot = slot_of (w->clock, 0);
+	l = &w->slots[0][slot];
+	ASSERT (!list_empty (l));
+	w->occupied[0] &= ~(1ULL << slot);
+	list_splice (list_end (&w->due), list_begin (l), list_end (l));
+
+	w->next = find_next (w);
+}
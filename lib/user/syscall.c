@@ -194,3 +194,47 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+bool
+schedstat (pid_t pid, struct sched_stats *stats) {
+	return syscall2 (SYS_SCHEDSTAT, pid, stats);
+}
+
+int
+futex (int *uaddr, int op, int val) {
+	return syscall3 (SYS_FUTEX, uaddr, op, val);
+}
+
+int
+lockstat (struct lockstat *stats, int cnt) {
+	return syscall2 (SYS_LOCKSTAT, stats, cnt);
+}
+
+/* Runs FUNC (AUX) in a thread started by uthread_create(), and
+   ends the thread if FUNC returns. */
+static void
+uthread_start (uthread_func *func, void *aux) {
+	func (aux);
+	uthread_exit (0);
+}
+
+tid_t
+uthread_create (uthread_func *func, void *aux) {
+	return (tid_t) syscall3 (SYS_UTHREAD_CREATE, uthread_start, func, aux);
+}
+
+void
+uthread_exit (int status) {
+	syscall1 (SYS_UTHREAD_EXIT, status);
+	NOT_REACHED ();
+}
+
+int
+uthread_join (tid_t tid) {
+	return syscall1 (SYS_UTHREAD_JOIN, tid);
+}
+
+int
+clock_gettime (int clock, struct timespec *ts) {
+	return syscall2 (SYS_CLOCK_GETTIME, clock, ts);
+}
@@ -0,0 +1,53 @@
+/* Sleeps for several times shorter than a timer tick with
+   timer_usleep() and checks, by timer_ns(), that each sleep lasts
+   at least as long as asked.  A lower-priority thread spins
+   meanwhile, and must make progress during each sleep, which shows
+   that the sleeping thread blocked instead of busy-waiting. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static thread_func spinner;
+static volatile int64_t spin_cnt;
+static volatile bool done;
+
+void
+test_alarm_usleep (void) 
+{
+  static const long long sleeps[] = {100, 500, 2000, 7000};
+  size_t i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  thread_create ("spinner", PRI_DEFAULT - 1, spinner, NULL);
+
+  for (i = 0; i < sizeof sleeps / sizeof *sleeps; i++) 
+    {
+      int64_t before = spin_cnt;
+      int64_t start = timer_ns ();
+      int64_t elapsed;
+
+      timer_usleep (sleeps[i]);
+      elapsed = timer_ns () - start;
+      if (elapsed < sleeps[i] * 1000)
+        fail ("timer_usleep (%lld) returned after only %lld ns",
+              sleeps[i], (long long) elapsed);
+      if (spin_cnt == before)
+        fail ("spinner did not run during timer_usleep (%lld)", sleeps[i]);
+      msg ("timer_usleep (%lld) blocked long enough.", sleeps[i]);
+    }
+
+  /* Let the spinner finish. */
+  done = true;
+  timer_msleep (10);
+}
+
+static void
+spinner (void *aux UNUSED) 
+{
+  while (!done)
+    spin_cnt++;
+}
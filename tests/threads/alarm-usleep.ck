@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(alarm-usleep) begin
+(alarm-usleep) timer_usleep (100) blocked long enough.
+(alarm-usleep) timer_usleep (500) blocked long enough.
+(alarm-usleep) timer_usleep (2000) blocked long enough.
+(alarm-usleep) timer_usleep (7000) blocked long enough.
+(alarm-usleep) end
+EOF
+pass;
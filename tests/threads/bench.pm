@@ -0,0 +1,31 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+# Checks the output of a benchmark.  Benchmark results depend on
+# the machine, so they are not compared against anything; the test
+# passes if it ran to completion and printed one line matching each
+# of the given regular expressions, in order.
+sub check_bench {
+    my (@patterns) = @_;
+    our ($test);
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my ($name) = $test =~ m%([^/]+)$%;
+    fail "missing \"($name) end\" in output"
+      unless grep ($_ eq "($name) end", @output);
+
+    my ($i) = 0;
+    foreach my $line (@output) {
+	last if $i >= @patterns;
+	$i++ if $line =~ /^\($name\) $patterns[$i]$/;
+    }
+    fail "missing result line matching /$patterns[$i]/ in output"
+      if $i < @patterns;
+    pass;
+}
+
+1;
@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+
+check_bench ('lock: \d+ cycles per increment\.',
+	     'spinlock: \d+ cycles per increment\.',
+	     'intr_disable: \d+ cycles per increment\.',
+	     'xaddq: \d+ cycles per increment\.');
@@ -0,0 +1,89 @@
+/* Measures how long READER_CNT threads take to each hold a lock
+   ROUND_CNT times, sleeping one tick while they hold it as if
+   waiting for the disk, first with an ordinary lock and then with
+   a readers-writer lock taken for reading.
+
+   With a lock the readers take turns, so this takes about
+   READER_CNT * ROUND_CNT ticks; with an rwlock they sleep side by
+   side, in about ROUND_CNT ticks.  The times are printed but not
+   checked, since they depend on the machine. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define READER_CNT 4
+#define ROUND_CNT 10
+
+static thread_func lock_reader;
+static thread_func rwlock_reader;
+
+static struct lock lock;
+static struct rwlock rw;
+static struct semaphore done;
+
+static void run (const char *how, thread_func *);
+
+void
+test_rwlock_readers (void) 
+{
+  lock_init (&lock);
+  rwlock_init (&rw);
+  sema_init (&done, 0);
+
+  run ("lock", lock_reader);
+  run ("rwlock", rwlock_reader);
+}
+
+/* Runs READER_CNT threads of FUNC and reports how long they took
+   using HOW. */
+static void
+run (const char *how, thread_func *func) 
+{
+  int64_t start = timer_ticks ();
+  int i;
+
+  for (i = 0; i < READER_CNT; i++) 
+    {
+      char name[16];
+
+      snprintf (name, sizeof name, "reader %d", i);
+      thread_create (name, PRI_DEFAULT, func, NULL);
+    }
+  for (i = 0; i < READER_CNT; i++)
+    sema_down (&done);
+
+  msg ("%s: %lld ticks for %d readers.", how, timer_elapsed (start),
+       READER_CNT);
+}
+
+static void
+lock_reader (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      lock_acquire (&lock);
+      timer_sleep (1);
+      lock_release (&lock);
+    }
+  sema_up (&done);
+}
+
+static void
+rwlock_reader (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      rwlock_read_acquire (&rw);
+      timer_sleep (1);
+      rwlock_read_release (&rw);
+    }
+  sema_up (&done);
+}
@@ -0,0 +1,8 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+
+check_bench ('lock: \d+ ticks for \d+ readers\.',
+	     'rwlock: \d+ ticks for \d+ readers\.');
@@ -0,0 +1,71 @@
+/* Measures how fast two threads can hand the CPU back and forth
+   through a pair of semaphores.
+
+   The main thread ups one semaphore and downs the other, and a
+   second thread of the same priority does the opposite, so each
+   round trip is exactly two context switches and little else.
+   The switch rate is printed but not checked, since it depends
+   on the machine; compare it across kernels to see the effect of
+   a change to the switch path. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of round trips. */
+#define ROUND_CNT 100000
+
+static thread_func pong_thread;
+static struct semaphore ping, pong;
+
+void
+test_sema_pingpong (void) 
+{
+  int64_t start, elapsed;
+  long long switch_cnt;
+  int i;
+
+  ASSERT (!thread_mlfqs);
+  ASSERT (!thread_fair);
+
+  sema_init (&ping, 0);
+  sema_init (&pong, 0);
+  thread_create ("pong", thread_get_priority (), pong_thread, NULL);
+
+  /* Let the partner get going, then start on a tick boundary. */
+  sema_up (&ping);
+  sema_down (&pong);
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      sema_up (&ping);
+      sema_down (&pong);
+    }
+  elapsed = timer_elapsed (start);
+  if (elapsed == 0)
+    elapsed = 1;
+
+  switch_cnt = 2LL * ROUND_CNT;
+  msg ("%lld switches in %lld ticks (%lld switches per second).",
+       switch_cnt, elapsed, switch_cnt * TIMER_FREQ / elapsed);
+}
+
+static void
+pong_thread (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ROUND_CNT + 1; i++) 
+    {
+      sema_down (&ping);
+      sema_up (&pong);
+    }
+}
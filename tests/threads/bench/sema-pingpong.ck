@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+
+check_bench ('\d+ switches in \d+ ticks \(\d+ switches per second\)\.');
@@ -0,0 +1,8 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::bench;
+
+check_bench ('sema_up: \d+ cycles per wakeup with \d+ waiters\.',
+	     'cond_signal: \d+ cycles per wakeup with \d+ waiters\.');
@@ -0,0 +1,64 @@
+/* Checks admission control for EDF real-time threads.
+
+   Bad parameters are refused.  A thread is refused if admitting
+   it would give real-time threads more than 95% of the CPU, and
+   the share a real-time thread held is given back when it exits.
+   While the main thread is a real-time thread, even a thread of
+   the highest priority does not preempt it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func admit_thread;
+static thread_func high_thread;
+
+static struct semaphore done;
+
+void
+test_edf_admit (void) 
+{
+  sema_init (&done, 0);
+
+  if (!thread_set_deadline (3, 2, 10))
+    msg ("Runtime longer than deadline refused.");
+  if (!thread_set_deadline (2, 10, 5))
+    msg ("Deadline longer than period refused.");
+
+  if (thread_set_deadline (50, 100, 100))
+    msg ("Main thread admitted at 50%%.");
+
+  thread_create ("admit", PRI_DEFAULT, admit_thread, NULL);
+  sema_down (&done);
+
+  if (thread_set_deadline (90, 100, 100))
+    msg ("Main thread admitted at 90%% after the other exited.");
+
+  msg ("Creating a thread of the highest priority.");
+  thread_create ("high", PRI_MAX, high_thread, NULL);
+  msg ("Main thread still running.");
+  thread_deadline_yield ();
+  sema_down (&done);
+
+  if (thread_set_deadline (0, 0, 0))
+    msg ("Main thread left the real-time class.");
+}
+
+static void
+admit_thread (void *aux UNUSED) 
+{
+  if (!thread_set_deadline (5, 10, 10))
+    msg ("Second thread refused at 50%%.");
+  if (thread_set_deadline (4, 10, 10))
+    msg ("Second thread admitted at 40%%.");
+  sema_up (&done);
+}
+
+static void
+high_thread (void *aux UNUSED) 
+{
+  msg ("High-priority thread running.");
+  sema_up (&done);
+}
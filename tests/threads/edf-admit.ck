@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-admit) begin
+(edf-admit) Runtime longer than deadline refused.
+(edf-admit) Deadline longer than period refused.
+(edf-admit) Main thread admitted at 50%.
+(edf-admit) Second thread refused at 50%.
+(edf-admit) Second thread admitted at 40%.
+(edf-admit) Main thread admitted at 90% after the other exited.
+(edf-admit) Creating a thread of the highest priority.
+(edf-admit) Main thread still running.
+(edf-admit) High-priority thread running.
+(edf-admit) Main thread left the real-time class.
+(edf-admit) end
+EOF
+pass;
@@ -0,0 +1,154 @@
+/* Measures deadline misses of EDF real-time threads under load.
+
+   Two real-time threads run periodic jobs, and a third uses up
+   its runtime in every period without ever ending a job, all
+   while two CPU-bound threads of the highest priority compete
+   for the CPU.  The real-time threads, 80% of the CPU between
+   them, should miss no deadlines; the third should be throttled,
+   leaving the CPU-bound threads the rest of the time. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Length of the test, in ticks. */
+#define TEST_TICKS 300
+
+/* Number of CPU-bound threads. */
+#define SPIN_CNT 2
+
+struct task 
+  {
+    const char *name;
+    int64_t runtime, deadline, period;
+    int jobs;                   /* Number of jobs to run. */
+    struct sched_stats stats;
+    struct semaphore done;
+  };
+
+static struct task tasks[] = 
+  {
+    {.name = "rt-5", .runtime = 2, .deadline = 5, .period = 5, .jobs = 50},
+    {.name = "rt-15", .runtime = 3, .deadline = 15, .period = 15,
+     .jobs = 16},
+    {.name = "rt-hog", .runtime = 2, .deadline = 10, .period = 10,
+     .jobs = 0},
+  };
+#define TASK_CNT (sizeof tasks / sizeof *tasks)
+#define HOG (&tasks[TASK_CNT - 1])
+
+static struct sched_stats spin_stats[SPIN_CNT];
+static struct semaphore spin_done;
+static int64_t end_tick;
+
+static thread_func periodic_thread;
+static thread_func hog_thread;
+static thread_func spin_thread;
+static void run_ticks (int64_t);
+
+void
+test_edf_load (void) 
+{
+  int64_t spin_ticks = 0;
+  size_t i;
+
+  sema_init (&spin_done, 0);
+  end_tick = timer_ticks () + TEST_TICKS;
+
+  /* Stay ahead of the CPU-bound threads until they are all
+     created. */
+  thread_set_priority (PRI_MAX);
+  for (i = 0; i < TASK_CNT; i++) 
+    {
+      struct task *t = &tasks[i];
+      sema_init (&t->done, 0);
+      thread_create (t->name, PRI_MAX,
+                     t == HOG ? hog_thread : periodic_thread, t);
+    }
+  for (i = 0; i < SPIN_CNT; i++)
+    thread_create ("spin", PRI_MAX, spin_thread, &spin_stats[i]);
+  thread_set_priority (PRI_DEFAULT);
+
+  for (i = 0; i < TASK_CNT; i++)
+    sema_down (&tasks[i].done);
+  for (i = 0; i < SPIN_CNT; i++) 
+    {
+      sema_down (&spin_done);
+      spin_ticks += spin_stats[i].run_ticks;
+    }
+
+  for (i = 0; i < TASK_CNT; i++) 
+    {
+      struct task *t = &tasks[i];
+      if (t != HOG)
+        msg ("%s: %lld of %lld jobs missed their deadlines.", t->name,
+             t->stats.edf_misses, t->stats.edf_jobs);
+    }
+  msg ("%s was %s.", HOG->name,
+       HOG->stats.edf_throttles > 0 ? "throttled" : "never throttled");
+  msg ("CPU-bound threads got %s 10%% of the CPU.",
+       spin_ticks >= TEST_TICKS / 10 ? "at least" : "less than");
+}
+
+/* Runs T's jobs, one per period, each taking all but one tick
+   of its runtime. */
+static void
+periodic_thread (void *t_) 
+{
+  struct task *t = t_;
+  int i;
+
+  if (!thread_set_deadline (t->runtime, t->deadline, t->period))
+    fail ("%s not admitted", t->name);
+  for (i = 0; i < t->jobs; i++) 
+    {
+      run_ticks (t->runtime - 1);
+      thread_deadline_yield ();
+    }
+  thread_sched_stats (thread_current (), &t->stats);
+  sema_up (&t->done);
+}
+
+/* Runs without ever ending a job until the test is over. */
+static void
+hog_thread (void *t_) 
+{
+  struct task *t = t_;
+
+  if (!thread_set_deadline (t->runtime, t->deadline, t->period))
+    fail ("%s not admitted", t->name);
+  while (timer_ticks () < end_tick)
+    continue;
+  thread_set_deadline (0, 0, 0);
+  thread_sched_stats (thread_current (), &t->stats);
+  sema_up (&t->done);
+}
+
+/* Runs until the test is over. */
+static void
+spin_thread (void *stats_) 
+{
+  struct sched_stats *stats = stats_;
+
+  while (timer_ticks () < end_tick)
+    continue;
+  thread_sched_stats (thread_current (), stats);
+  sema_up (&spin_done);
+}
+
+/* Runs for TICKS timer ticks of CPU time. */
+static void
+run_ticks (int64_t ticks) 
+{
+  struct sched_stats s;
+  int64_t start;
+
+  thread_sched_stats (thread_current (), &s);
+  start = s.run_ticks;
+  do
+    thread_sched_stats (thread_current (), &s);
+  while (s.run_ticks - start < ticks);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-load) begin
+(edf-load) rt-5: 0 of 50 jobs missed their deadlines.
+(edf-load) rt-15: 0 of 16 jobs missed their deadlines.
+(edf-load) rt-hog was throttled.
+(edf-load) CPU-bound threads got at least 10% of the CPU.
+(edf-load) end
+EOF
+pass;
@@ -0,0 +1,87 @@
+/* Checks that each thread keeps its own FPU registers.
+
+   Several threads each load a value of their own into %xmm0 and
+   then yield or sleep, so that the others load theirs in between,
+   before reading the register back.  With lazy FPU switching each
+   read after a switch traps and must restore the thread's own
+   value, saved when another thread took the FPU over.  The main
+   thread, which has no FPU save area, only waits. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 3
+#define ITER_CNT 10
+
+struct fpu_thread 
+  {
+    uint64_t value;             /* Base of the values it loads. */
+    int bad_cnt;                /* Number of wrong values read back. */
+  };
+
+static struct fpu_thread threads[THREAD_CNT];
+static struct semaphore done;
+
+static thread_func fpu_thread;
+
+static void
+set_xmm0 (uint64_t value) 
+{
+  asm volatile ("movq %0, %%xmm0" : : "r" (value));
+}
+
+static uint64_t
+get_xmm0 (void) 
+{
+  uint64_t value;
+
+  asm volatile ("movq %%xmm0, %0" : "=r" (value));
+  return value;
+}
+
+void
+test_fpu_switch (void) 
+{
+  int i;
+
+  sema_init (&done, 0);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+
+      threads[i].value = 0x1111111111111111ULL * (i + 1);
+      threads[i].bad_cnt = 0;
+      snprintf (name, sizeof name, "fpu %d", i);
+      thread_create (name, PRI_DEFAULT, fpu_thread, &threads[i]);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    msg ("Thread %d read back %d wrong values.", i, threads[i].bad_cnt);
+}
+
+static void
+fpu_thread (void *ft_) 
+{
+  struct fpu_thread *ft = ft_;
+  int i;
+
+  for (i = 0; i < ITER_CNT; i++) 
+    {
+      uint64_t value = ft->value + i;
+
+      set_xmm0 (value);
+      if (i % 2 == 0)
+        thread_yield ();
+      else
+        timer_sleep (1);
+      if (get_xmm0 () != value)
+        ft->bad_cnt++;
+    }
+  sema_up (&done);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-switch) begin
+(fpu-switch) Thread 0 read back 0 wrong values.
+(fpu-switch) Thread 1 read back 0 wrong values.
+(fpu-switch) Thread 2 read back 0 wrong values.
+(fpu-switch) end
+EOF
+pass;
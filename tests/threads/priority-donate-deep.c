@@ -0,0 +1,71 @@
+/* Like priority-donate-chain, but the chain of donations is 20
+   locks long, deeper than any fixed nesting limit should be.
+
+   The main thread sets its priority to PRI_MIN and acquires lock
+   0.  Thread i, for i = 1...20, has priority PRI_MIN + 3 * i.  It
+   acquires lock i and then blocks on lock i - 1, so each new
+   thread's priority has to travel all the way down the chain to
+   the main thread.  When the main thread releases lock 0, the
+   chain unwinds and the main thread is left with its own
+   priority. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define DEPTH 20
+
+struct lock_pair 
+  {
+    struct lock *own;           /* Lock to hold. */
+    struct lock *wait;          /* Lock to wait for. */
+  };
+
+static thread_func donor_thread_func;
+
+/* Too big for the main thread's stack. */
+static struct lock locks[DEPTH + 1];
+static struct lock_pair pairs[DEPTH + 1];
+
+void
+test_priority_donate_deep (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  thread_set_priority (PRI_MIN);
+  for (i = 0; i <= DEPTH; i++)
+    lock_init (&locks[i]);
+  lock_acquire (&locks[0]);
+
+  for (i = 1; i <= DEPTH; i++) 
+    {
+      char name[16];
+      int priority = PRI_MIN + 3 * i;
+
+      snprintf (name, sizeof name, "donor %d", i);
+      pairs[i].own = &locks[i];
+      pairs[i].wait = &locks[i - 1];
+      thread_create (name, priority, donor_thread_func, &pairs[i]);
+      msg ("main should have priority %d.  Actual priority: %d.",
+           priority, thread_get_priority ());
+    }
+
+  lock_release (&locks[0]);
+  msg ("main finishing with priority %d.", thread_get_priority ());
+}
+
+static void
+donor_thread_func (void *pair_) 
+{
+  struct lock_pair *pair = pair_;
+
+  lock_acquire (pair->own);
+  lock_acquire (pair->wait);
+  lock_release (pair->wait);
+  lock_release (pair->own);
+}
@@ -0,0 +1,30 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-deep) begin
+(priority-donate-deep) main should have priority 3.  Actual priority: 3.
+(priority-donate-deep) main should have priority 6.  Actual priority: 6.
+(priority-donate-deep) main should have priority 9.  Actual priority: 9.
+(priority-donate-deep) main should have priority 12.  Actual priority: 12.
+(priority-donate-deep) main should have priority 15.  Actual priority: 15.
+(priority-donate-deep) main should have priority 18.  Actual priority: 18.
+(priority-donate-deep) main should have priority 21.  Actual priority: 21.
+(priority-donate-deep) main should have priority 24.  Actual priority: 24.
+(priority-donate-deep) main should have priority 27.  Actual priority: 27.
+(priority-donate-deep) main should have priority 30.  Actual priority: 30.
+(priority-donate-deep) main should have priority 33.  Actual priority: 33.
+(priority-donate-deep) main should have priority 36.  Actual priority: 36.
+(priority-donate-deep) main should have priority 39.  Actual priority: 39.
+(priority-donate-deep) main should have priority 42.  Actual priority: 42.
+(priority-donate-deep) main should have priority 45.  Actual priority: 45.
+(priority-donate-deep) main should have priority 48.  Actual priority: 48.
+(priority-donate-deep) main should have priority 51.  Actual priority: 51.
+(priority-donate-deep) main should have priority 54.  Actual priority: 54.
+(priority-donate-deep) main should have priority 57.  Actual priority: 57.
+(priority-donate-deep) main should have priority 60.  Actual priority: 60.
+(priority-donate-deep) main finishing with priority 0.
+(priority-donate-deep) end
+EOF
+pass;
@@ -0,0 +1,67 @@
+/* Checks that a readers-writer lock prefers writers and donates
+   priority to its writer and to its readers.
+
+   The main thread holds the lock for reading.  A writer of higher
+   priority then waits for it, donating its priority to the main
+   thread, and after that a reader of higher priority still, which
+   must wait behind the writer rather than join the main thread,
+   and must donate its priority to the writer and on through the
+   writer to the main thread.  Once the main thread lets go, it
+   drops back to its own priority, the writer gets the lock at the
+   donated priority, and the reader gets it once the writer is
+   done. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func writer_thread;
+static thread_func reader_thread;
+
+static struct rwlock rw;
+
+void
+test_rwlock (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+  rwlock_read_acquire (&rw);
+  msg ("Main thread holds the lock for reading.");
+
+  thread_create ("writer", PRI_DEFAULT + 1, writer_thread, NULL);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 1, thread_get_priority ());
+  thread_create ("reader", PRI_DEFAULT + 2, reader_thread, NULL);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 2, thread_get_priority ());
+
+  msg ("Main thread releasing the lock.");
+  rwlock_read_release (&rw);
+  msg ("Main thread done at priority %d.", thread_get_priority ());
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  msg ("Writer waiting for the lock.");
+  rwlock_write_acquire (&rw);
+  msg ("Writer got the lock at priority %d.", thread_get_priority ());
+  rwlock_write_release (&rw);
+  msg ("Writer done at priority %d.", thread_get_priority ());
+}
+
+static void
+reader_thread (void *aux UNUSED) 
+{
+  msg ("Reader waiting for the lock.");
+  rwlock_read_acquire (&rw);
+  msg ("Reader got the lock.");
+  rwlock_read_release (&rw);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock) begin
+(rwlock) Main thread holds the lock for reading.
+(rwlock) Writer waiting for the lock.
+(rwlock) Main thread should have priority 32.  Actual priority: 32.
+(rwlock) Reader waiting for the lock.
+(rwlock) Main thread should have priority 33.  Actual priority: 33.
+(rwlock) Main thread releasing the lock.
+(rwlock) Writer got the lock at priority 33.
+(rwlock) Reader got the lock.
+(rwlock) Writer done at priority 32.
+(rwlock) Main thread done at priority 31.
+(rwlock) end
+EOF
+pass;
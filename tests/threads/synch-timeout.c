@@ -0,0 +1,134 @@
+/* Checks the timed waits of semaphores, locks, condition
+   variables and readers-writer locks: each must give up once its
+   time runs out, no sooner, and must succeed when what it waits
+   for comes in time.  A thread that gives up waiting for a lock
+   must also take back the priority it donated to the holder. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* How long waits that should time out are given. */
+#define SHORT_WAIT 3
+
+/* How long waits that should succeed are given. */
+#define LONG_WAIT 100
+
+static thread_func upper_thread;
+static thread_func holder_thread;
+static thread_func signaler_thread;
+
+static struct semaphore sema, held, go;
+static struct lock lock;
+static struct condition cond;
+static struct rwlock rw;
+
+/* Reports whether at least SHORT_WAIT ticks passed since START. */
+static void
+check_elapsed (const char *what, int64_t start) 
+{
+  if (timer_elapsed (start) < SHORT_WAIT)
+    fail ("%s gave up after %lld ticks", what,
+          (long long) timer_elapsed (start));
+  msg ("%s timed out.", what);
+}
+
+void
+test_synch_timeout (void) 
+{
+  int64_t start;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  /* Semaphores. */
+  sema_init (&sema, 0);
+  start = timer_ticks ();
+  if (sema_down_timeout (&sema, SHORT_WAIT))
+    fail ("sema_down_timeout() downed a zero semaphore");
+  check_elapsed ("sema_down_timeout()", start);
+
+  sema_up (&sema);
+  if (!sema_down_timeout (&sema, 0))
+    fail ("sema_down_timeout() did not down a positive semaphore");
+  msg ("sema_down_timeout() downed a positive semaphore.");
+
+  thread_create ("upper", PRI_DEFAULT - 1, upper_thread, NULL);
+  if (!sema_down_timeout (&sema, LONG_WAIT))
+    fail ("sema_down_timeout() missed a sema_up()");
+  msg ("sema_down_timeout() woken by sema_up().");
+
+  /* Locks. */
+  lock_init (&lock);
+  sema_init (&held, 0);
+  sema_init (&go, 0);
+  thread_create ("holder", PRI_DEFAULT - 1, holder_thread, NULL);
+  sema_down (&held);
+  start = timer_ticks ();
+  if (lock_acquire_timeout (&lock, SHORT_WAIT))
+    fail ("lock_acquire_timeout() acquired a held lock");
+  check_elapsed ("lock_acquire_timeout()", start);
+  sema_up (&go);
+  timer_sleep (1);
+  if (!lock_acquire_timeout (&lock, LONG_WAIT))
+    fail ("lock_acquire_timeout() did not acquire a released lock");
+  msg ("lock_acquire_timeout() acquired a released lock.");
+
+  /* Condition variables. */
+  cond_init (&cond);
+  start = timer_ticks ();
+  if (cond_wait_timeout (&cond, &lock, SHORT_WAIT))
+    fail ("cond_wait_timeout() signaled with no signal");
+  if (!lock_held_by_current_thread (&lock))
+    fail ("cond_wait_timeout() did not reacquire the lock");
+  check_elapsed ("cond_wait_timeout()", start);
+
+  thread_create ("signaler", PRI_DEFAULT - 1, signaler_thread, NULL);
+  if (!cond_wait_timeout (&cond, &lock, LONG_WAIT))
+    fail ("cond_wait_timeout() missed a signal");
+  msg ("cond_wait_timeout() woken by cond_signal().");
+  lock_release (&lock);
+
+  /* Readers-writer locks. */
+  rwlock_init (&rw);
+  rwlock_read_acquire (&rw);
+  start = timer_ticks ();
+  if (rwlock_write_acquire_timeout (&rw, SHORT_WAIT))
+    fail ("rwlock_write_acquire_timeout() acquired a read-held lock");
+  check_elapsed ("rwlock_write_acquire_timeout()", start);
+  rwlock_read_release (&rw);
+  if (!rwlock_write_acquire_timeout (&rw, SHORT_WAIT))
+    fail ("rwlock_write_acquire_timeout() did not acquire a free lock");
+  msg ("rwlock_write_acquire_timeout() acquired a free lock.");
+  rwlock_write_release (&rw);
+}
+
+static void
+upper_thread (void *aux UNUSED) 
+{
+  sema_up (&sema);
+}
+
+static void
+holder_thread (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  sema_up (&held);
+  msg ("Holder has the lock at priority %d.", thread_get_priority ());
+  sema_down (&go);
+  msg ("Holder woke at priority %d.", thread_get_priority ());
+  lock_release (&lock);
+}
+
+static void
+signaler_thread (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  cond_signal (&cond, &lock);
+  lock_release (&lock);
+}
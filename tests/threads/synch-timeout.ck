@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(synch-timeout) begin
+(synch-timeout) sema_down_timeout() timed out.
+(synch-timeout) sema_down_timeout() downed a positive semaphore.
+(synch-timeout) sema_down_timeout() woken by sema_up().
+(synch-timeout) Holder has the lock at priority 31.
+(synch-timeout) lock_acquire_timeout() timed out.
+(synch-timeout) Holder woke at priority 30.
+(synch-timeout) lock_acquire_timeout() acquired a released lock.
+(synch-timeout) cond_wait_timeout() timed out.
+(synch-timeout) cond_wait_timeout() woken by cond_signal().
+(synch-timeout) rwlock_write_acquire_timeout() timed out.
+(synch-timeout) rwlock_write_acquire_timeout() acquired a free lock.
+(synch-timeout) end
+EOF
+pass;
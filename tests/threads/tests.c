@@ -17,6 +17,7 @@ static const struct test tests[] =
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-usleep", test_alarm_usleep},
     {"priority-change", test_priority_change},
     {"priority-donate-one", test_priority_donate_one},
     {"priority-donate-multiple", test_priority_donate_multiple},
@@ -25,6 +26,15 @@ static const struct test tests[] =
     {"priority-donate-sema", test_priority_donate_sema},
     {"priority-donate-lower", test_priority_donate_lower},
     {"priority-donate-chain", test_priority_donate_chain},
+    {"priority-donate-deep", test_priority_donate_deep},
+    {"workqueue", test_workqueue},
+    {"workqueue-requeue", test_workqueue_requeue},
+    {"edf-admit", test_edf_admit},
+    {"edf-load", test_edf_load},
+    {"rwlock", test_rwlock},
+    {"timeout", test_timeout},
+    {"synch-timeout", test_synch_timeout},
+    {"fpu-switch", test_fpu_switch},
     {"priority-fifo", test_priority_fifo},
     {"priority-preempt", test_priority_preempt},
     {"priority-sema", test_priority_sema},
@@ -38,6 +48,14 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"fair-share-2", test_fair_share_2},
+    {"fair-share-20", test_fair_share_20},
+    {"fair-nice-2", test_fair_nice_2},
+    {"fair-nice-10", test_fair_nice_10},
+    {"sema-pingpong", test_sema_pingpong},
+    {"atomic-counter", test_atomic_counter},
+    {"rwlock-readers", test_rwlock_readers},
+    {"sema-waiters", test_sema_waiters},
   };
 
 static const char *test_name;
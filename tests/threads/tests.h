@@ -11,6 +11,7 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_usleep;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -19,6 +20,15 @@ extern test_func test_priority_donate_sema;
 extern test_func test_priority_donate_nest;
 extern test_func test_priority_donate_lower;
 extern test_func test_priority_donate_chain;
+extern test_func test_priority_donate_deep;
+extern test_func test_workqueue;
+extern test_func test_workqueue_requeue;
+extern test_func test_edf_admit;
+extern test_func test_edf_load;
+extern test_func test_rwlock;
+extern test_func test_timeout;
+extern test_func test_synch_timeout;
+extern test_func test_fpu_switch;
 extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
@@ -32,6 +42,14 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_fair_share_2;
+extern test_func test_fair_share_20;
+extern test_func test_fair_nice_2;
+extern test_func test_fair_nice_10;
+extern test_func test_sema_pingpong;
+extern test_func test_atomic_counter;
+extern test_func test_rwlock_readers;
+extern test_func test_sema_waiters;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,81 @@
+/* Checks that timeouts run their functions at the ticks they were
+   added or moved to, in order, and not at all once canceled, and
+   that a timeout's function may add it again. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* A timeout that records when it runs. */
+struct probe 
+  {
+    struct timeout timeout;
+    char name;                  /* Recorded in `fired' when it runs. */
+    int64_t expires;            /* Tick it should run at. */
+    int repeat;                 /* Times to add it again. */
+    int64_t period;             /* Ticks between repeats. */
+  };
+
+static timeout_func probe_fire;
+
+/* Names of the probes, in the order they ran. */
+static char fired[16];
+static size_t fired_cnt;
+static bool early;
+
+void
+test_timeout (void) 
+{
+  struct probe a = {.name = 'A'}, b = {.name = 'B'};
+  struct probe c = {.name = 'C'}, d = {.name = 'D', .repeat = 2, .period = 3};
+  enum intr_level old_level;
+  int64_t start;
+
+  timeout_init (&a.timeout, probe_fire);
+  timeout_init (&b.timeout, probe_fire);
+  timeout_init (&c.timeout, probe_fire);
+  timeout_init (&d.timeout, probe_fire);
+
+  /* Set everything up within one tick. */
+  old_level = intr_disable ();
+  start = timer_ticks ();
+  timeout_add (&a.timeout, a.expires = start + 4);
+  timeout_add (&b.timeout, b.expires = start + 2);
+  timeout_add (&c.timeout, c.expires = start + 1);
+  timeout_add (&d.timeout, d.expires = start + 2);
+  if (!timeout_cancel (&b.timeout))
+    fail ("pending timeout not canceled");
+  if (timeout_cancel (&b.timeout))
+    fail ("canceled timeout canceled again");
+  if (!timeout_mod (&c.timeout, c.expires = start + 6))
+    fail ("pending timeout not moved");
+  intr_set_level (old_level);
+  msg ("Added A at +4, D at +2 and every 3 ticks after, "
+       "C at +6, and canceled B.");
+
+  timer_sleep (12);
+
+  fired[fired_cnt] = '\0';
+  msg ("Ran in order %s.", fired);
+  if (early)
+    fail ("a timeout ran early");
+  if (timeout_pending (&a.timeout) || timeout_pending (&b.timeout)
+      || timeout_pending (&c.timeout) || timeout_pending (&d.timeout))
+    fail ("a timeout is still pending");
+  msg ("None ran early.");
+}
+
+static void
+probe_fire (struct timeout *t) 
+{
+  struct probe *p = timeout_entry (t, struct probe, timeout);
+
+  if (timer_ticks () < p->expires)
+    early = true;
+  if (fired_cnt < sizeof fired - 1)
+    fired[fired_cnt++] = p->name;
+  if (p->repeat-- > 0)
+    timeout_add (t, p->expires += p->period);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timeout) begin
+(timeout) Added A at +4, D at +2 and every 3 ticks after, C at +6, and canceled B.
+(timeout) Ran in order DADCD.
+(timeout) None ran early.
+(timeout) end
+EOF
+pass;
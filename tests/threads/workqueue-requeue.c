@@ -0,0 +1,68 @@
+/* Checks that an item a worker has taken in a batch, but not yet
+   started, still counts as pending.
+
+   A low-priority worker takes a batch of two items, the first of
+   which blocks.  While it does, queuing the second item again must
+   fail, and canceling it must succeed, after which it can be
+   queued again and then runs exactly once. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+static struct workqueue wq;
+static struct work blocker, item;
+static struct semaphore started, resume;
+static int item_runs;
+
+static void
+block (struct work *w UNUSED) 
+{
+  sema_up (&started);
+  sema_down (&resume);
+}
+
+static void
+count (struct work *w UNUSED) 
+{
+  item_runs++;
+}
+
+static const char *
+bool_str (bool b) 
+{
+  return b ? "true" : "false";
+}
+
+void
+test_workqueue_requeue (void) 
+{
+  /* This test does not work with the MLFQS or -fair, which do not
+     honor priorities. */
+  ASSERT (!thread_mlfqs && !thread_fair);
+
+  sema_init (&started, 0);
+  sema_init (&resume, 0);
+  workqueue_init (&wq, "requeue", PRI_DEFAULT - 1, 1);
+  work_init (&blocker, block);
+  work_init (&item, count);
+  workqueue_queue (&wq, &blocker);
+  workqueue_queue (&wq, &item);
+
+  /* Let the worker take both items and start the first. */
+  sema_down (&started);
+  msg ("pending in batch: %s", bool_str (work_pending (&item)));
+  msg ("queue again: %s", bool_str (workqueue_queue (&wq, &item)));
+  msg ("cancel: %s", bool_str (workqueue_cancel (&item)));
+  msg ("queue after cancel: %s", bool_str (workqueue_queue (&wq, &item)));
+
+  sema_up (&resume);
+  workqueue_flush (&wq);
+  msg ("item ran %d time(s)", item_runs);
+  msg ("queue after run: %s", bool_str (workqueue_queue (&wq, &item)));
+  workqueue_flush (&wq);
+  msg ("item ran %d time(s)", item_runs);
+}
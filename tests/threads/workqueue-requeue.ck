@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue-requeue) begin
+(workqueue-requeue) pending in batch: true
+(workqueue-requeue) queue again: false
+(workqueue-requeue) cancel: true
+(workqueue-requeue) queue after cancel: true
+(workqueue-requeue) item ran 1 time(s)
+(workqueue-requeue) queue after run: true
+(workqueue-requeue) item ran 2 time(s)
+(workqueue-requeue) end
+EOF
+pass;
@@ -0,0 +1,76 @@
+/* Checks the basic work queue operations.
+
+   Items queued on a queue whose single worker has a lower
+   priority than the main thread do not run until the main thread
+   waits in workqueue_flush(), and then run in order, as one
+   batch, except for the one that was canceled.  An item on a
+   queue whose workers have a higher priority runs right away. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+#define ITEM_CNT 5
+
+struct item 
+  {
+    struct work work;
+    int id;
+  };
+
+static struct workqueue low_wq, high_wq;
+static struct item items[ITEM_CNT];
+static struct work urgent;
+static int ran[ITEM_CNT];
+static int ran_cnt;
+
+static void
+record (struct work *w) 
+{
+  ran[ran_cnt++] = work_entry (w, struct item, work)->id;
+}
+
+static void
+report (struct work *w UNUSED) 
+{
+  msg ("urgent item ran");
+}
+
+void
+test_workqueue (void) 
+{
+  char buf[64];
+  int ofs = 0;
+  int i;
+
+  /* This test does not work with the MLFQS or -fair, which do not
+     honor priorities. */
+  ASSERT (!thread_mlfqs && !thread_fair);
+
+  workqueue_init (&low_wq, "low", PRI_DEFAULT - 1, 1);
+  for (i = 0; i < ITEM_CNT; i++) 
+    {
+      items[i].id = i;
+      work_init (&items[i].work, record);
+      workqueue_queue (&low_wq, &items[i].work);
+    }
+  msg ("queue again: %s",
+       workqueue_queue (&low_wq, &items[0].work) ? "true" : "false");
+  msg ("cancel item 3: %s",
+       workqueue_cancel (&items[3].work) ? "true" : "false");
+  msg ("ran before flush: %d", ran_cnt);
+
+  workqueue_flush (&low_wq);
+  for (i = 0; i < ran_cnt; i++)
+    ofs += snprintf (buf + ofs, sizeof buf - ofs, " %d", ran[i]);
+  msg ("ran:%s", buf);
+  msg ("%lld batch(es)", low_wq.batch_cnt);
+
+  workqueue_init (&high_wq, "high", PRI_DEFAULT + 1, 2);
+  work_init (&urgent, report);
+  workqueue_queue (&high_wq, &urgent);
+  msg ("back in main");
+}
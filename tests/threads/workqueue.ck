@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) queue again: false
+(workqueue) cancel item 3: true
+(workqueue) ran before flush: 0
+(workqueue) ran: 0 1 2 4
+(workqueue) 1 batch(es)
+(workqueue) urgent item ran
+(workqueue) back in main
+(workqueue) end
+EOF
+pass;
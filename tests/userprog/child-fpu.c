@@ -0,0 +1,20 @@
+/* Child process run by the fpu-exec test.  Checks that %xmm0 does
+   not hold the value fpu-exec loaded before exec(). */
+
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/userprog/fpu.h"
+
+const char *test_name = "child-fpu";
+
+int
+main (void) 
+{
+  uint64_t value;
+
+  asm volatile ("movq %%xmm0, %0" : "=r" (value));
+  if (value == FPU_EXEC_VALUE)
+    fail ("xmm0 still holds the value loaded before exec");
+  msg ("xmm0 was reset");
+  return 66;
+}
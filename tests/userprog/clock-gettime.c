@@ -0,0 +1,48 @@
+/* Reads the monotonic clock many times and checks that it never
+   goes backward and that it advances in steps finer than a timer
+   tick, then checks that an unknown clock is refused. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Timer ticks are 10 ms apart. */
+#define TICK_NS 10000000LL
+
+static int64_t
+ts_ns (const struct timespec *ts) 
+{
+  return ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+void
+test_main (void) 
+{
+  struct timespec ts;
+  bool valid = true, monotonic = true;
+  int64_t start, prev, now, min_step = TICK_NS;
+
+  CHECK (clock_gettime (CLOCK_MONOTONIC, &ts) == 0,
+         "clock_gettime(CLOCK_MONOTONIC)");
+  start = prev = ts_ns (&ts);
+
+  /* Spin until at least two ticks' worth of time has passed. */
+  do 
+    {
+      clock_gettime (CLOCK_MONOTONIC, &ts);
+      if (ts.tv_sec < 0 || ts.tv_nsec < 0 || ts.tv_nsec >= 1000000000)
+        valid = false;
+      now = ts_ns (&ts);
+      if (now < prev)
+        monotonic = false;
+      else if (now > prev && now - prev < min_step)
+        min_step = now - prev;
+      prev = now;
+    }
+  while (now - start < 2 * TICK_NS);
+
+  CHECK (valid, "times are well formed");
+  CHECK (monotonic, "clock never goes backward");
+  CHECK (min_step < TICK_NS, "clock resolves less than a tick");
+  CHECK (clock_gettime (-1, &ts) == -1, "clock_gettime(-1) fails");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clock-gettime) begin
+(clock-gettime) clock_gettime(CLOCK_MONOTONIC)
+(clock-gettime) times are well formed
+(clock-gettime) clock never goes backward
+(clock-gettime) clock resolves less than a tick
+(clock-gettime) clock_gettime(-1) fails
+(clock-gettime) end
+clock-gettime: exit(0)
+EOF
+pass;
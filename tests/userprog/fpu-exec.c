@@ -0,0 +1,17 @@
+/* Loads a value into %xmm0 and execs child-fpu, which must not
+   find it there: exec() starts the new program with the initial
+   FPU state. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/fpu.h"
+
+void
+test_main (void) 
+{
+  asm volatile ("movq %0, %%xmm0" : : "r" (FPU_EXEC_VALUE));
+  msg ("xmm0 loaded");
+  exec ("child-fpu");
+}
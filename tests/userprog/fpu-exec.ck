@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-exec) begin
+(fpu-exec) xmm0 loaded
+(child-fpu) xmm0 was reset
+fpu-exec: exit(66)
+EOF
+pass;
@@ -0,0 +1,51 @@
+/* Loads a value into %xmm0 and forks.  The child must start with
+   the same value, and the parent must still have it after the
+   child has loaded a value of its own and exited. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PARENT_VALUE 0x0123456789abcdefULL
+#define CHILD_VALUE 0xfedcba9876543210ULL
+
+static void
+set_xmm0 (uint64_t value) 
+{
+  asm volatile ("movq %0, %%xmm0" : : "r" (value));
+}
+
+static uint64_t
+get_xmm0 (void) 
+{
+  uint64_t value;
+
+  asm volatile ("movq %%xmm0, %0" : "=r" (value));
+  return value;
+}
+
+void
+test_main (void) 
+{
+  int pid;
+
+  set_xmm0 (PARENT_VALUE);
+  if ((pid = fork ("child")))
+    {
+      int status = wait (pid);
+
+      msg ("Parent: child exit status is %d", status);
+      if (get_xmm0 () != PARENT_VALUE)
+        fail ("parent's xmm0 changed");
+      msg ("parent kept its xmm0");
+    }
+  else
+    {
+      if (get_xmm0 () != PARENT_VALUE)
+        fail ("child's xmm0 is not its parent's");
+      msg ("child inherited xmm0");
+      set_xmm0 (CHILD_VALUE);
+      exit (get_xmm0 () == CHILD_VALUE ? 81 : 1);
+    }
+}
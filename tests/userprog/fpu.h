@@ -0,0 +1,8 @@
+#ifndef TESTS_USERPROG_FPU_H
+#define TESTS_USERPROG_FPU_H
+
+/* Value that fpu-exec loads into %xmm0 before exec(), which
+   child-fpu must not find there. */
+#define FPU_EXEC_VALUE 0x0123456789abcdefULL
+
+#endif /* tests/userprog/fpu.h */
@@ -0,0 +1,24 @@
+/* Exercises the futex() system call without sleeping in it:
+   waiting on a futex that no longer holds the expected value
+   returns at once, waking one that nobody waits on wakes nobody,
+   and bad operations and misaligned addresses are refused. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word[2];
+
+void
+test_main (void) 
+{
+  word[0] = 1;
+  CHECK (futex (&word[0], FUTEX_WAIT, 0) == -1,
+         "wait for a changed value returns -1");
+  CHECK (futex (&word[0], FUTEX_WAKE, 1) == 0,
+         "wake with no waiters wakes none");
+  CHECK (futex (&word[0], FUTEX_WAKE, 0) == 0, "wake of 0 wakes none");
+  CHECK (futex (&word[0], 42, 0) == -1, "bad operation returns -1");
+  CHECK (futex ((int *) ((char *) &word[0] + 1), FUTEX_WAIT, 0) == -1,
+         "misaligned address returns -1");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-basic) begin
+(futex-basic) wait for a changed value returns -1
+(futex-basic) wake with no waiters wakes none
+(futex-basic) wake of 0 wakes none
+(futex-basic) bad operation returns -1
+(futex-basic) misaligned address returns -1
+(futex-basic) end
+futex-basic: exit(0)
+EOF
+pass;
@@ -0,0 +1,45 @@
+/* Reads the kernel's lock statistics and checks that they are
+   self-consistent and include the file system lock, which reading
+   a file and printing our messages must have taken. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct lockstat stats[LOCKSTAT_MAX];
+
+void
+test_main (void) 
+{
+  bool consistent = true, sorted = true, found = false;
+  char buf[16];
+  int handle;
+  int cnt;
+  int i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (handle, buf, sizeof buf) == (int) sizeof buf,
+         "read \"sample.txt\"");
+  close (handle);
+
+  cnt = lockstat (stats, LOCKSTAT_MAX);
+  CHECK (cnt > 0 && cnt <= LOCKSTAT_MAX, "lockstat() reports some locks");
+  for (i = 0; i < cnt; i++) 
+    {
+      if (stats[i].acquire_cnt == 0
+          || stats[i].contended_cnt > stats[i].acquire_cnt)
+        consistent = false;
+      if (i > 0 && stats[i].wait_cycles > stats[i - 1].wait_cycles)
+        sorted = false;
+      if (!strcmp (stats[i].name, "filesys"))
+        found = true;
+    }
+  CHECK (consistent, "counts are consistent");
+  CHECK (sorted, "most waited-for locks come first");
+  CHECK (found, "file system lock is reported");
+
+  CHECK (lockstat (stats, 1) == 1, "lockstat(1) reports one lock");
+  CHECK (lockstat (stats, 0) == 0, "lockstat(0) reports none");
+  CHECK (lockstat (stats, -1) == -1, "lockstat(-1) fails");
+}
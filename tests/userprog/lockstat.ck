@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(lockstat) begin
+(lockstat) open "sample.txt"
+(lockstat) read "sample.txt"
+(lockstat) lockstat() reports some locks
+(lockstat) counts are consistent
+(lockstat) most waited-for locks come first
+(lockstat) file system lock is reported
+(lockstat) lockstat(1) reports one lock
+(lockstat) lockstat(0) reports none
+(lockstat) lockstat(-1) fails
+(lockstat) end
+lockstat: exit(0)
+EOF
+pass;
@@ -0,0 +1,48 @@
+/* Reads scheduling statistics for this process, for a child,
+   and for the whole system, and checks that they are
+   self-consistent.  A pid that is not a child is refused. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static void
+check_stats (const char *who, const struct sched_stats *s) 
+{
+  int64_t sum = 0;
+  int i;
+
+  for (i = 0; i < SCHED_LAT_BUCKETS; i++)
+    sum += s->lat_hist[i];
+  CHECK (s->run_ticks >= 0 && s->wait_ticks >= 0
+         && s->nvcsw >= 0 && s->nivcsw >= 0,
+         "%s: counters are nonnegative", who);
+  CHECK (sum == s->wakeup_cnt, "%s: histogram sums to wakeup count", who);
+}
+
+void
+test_main (void) 
+{
+  struct sched_stats s, cs;
+  bool child_ok;
+  int pid;
+
+  CHECK (schedstat (0, &s), "schedstat(0)");
+  check_stats ("self", &s);
+
+  /* The child's output may interleave with ours, so print nothing
+     between fork() and wait(). */
+  if ((pid = fork ("child-simple")) == 0)
+    exec ("child-simple");
+  child_ok = pid > 0 && schedstat (pid, &cs);
+  msg ("wait(child) = %d", wait (pid));
+  CHECK (child_ok, "schedstat(child)");
+  check_stats ("child", &cs);
+  CHECK (cs.wakeup_cnt >= 1, "child: ran at least once");
+
+  CHECK (schedstat (SCHEDSTAT_ALL, &s), "schedstat(SCHEDSTAT_ALL)");
+  check_stats ("system", &s);
+  CHECK (s.nvcsw > 0, "system: some thread has blocked");
+
+  CHECK (!schedstat (12345, &s), "schedstat(12345) fails");
+}
@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(schedstat) begin
+(schedstat) schedstat(0)
+(schedstat) self: counters are nonnegative
+(schedstat) self: histogram sums to wakeup count
+(child-simple) run
+child-simple: exit(81)
+(schedstat) wait(child) = 81
+(schedstat) schedstat(child)
+(schedstat) child: counters are nonnegative
+(schedstat) child: histogram sums to wakeup count
+(schedstat) child: ran at least once
+(schedstat) schedstat(SCHEDSTAT_ALL)
+(schedstat) system: counters are nonnegative
+(schedstat) system: histogram sums to wakeup count
+(schedstat) system: some thread has blocked
+(schedstat) schedstat(12345) fails
+(schedstat) end
+schedstat: exit(0)
+EOF
+pass;
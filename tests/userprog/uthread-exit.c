@@ -0,0 +1,49 @@
+/* Starts a thread that spins in user mode, one that joins it, and
+   one that calls exit(), while the main thread sleeps in
+   FUTEX_WAIT on a futex nobody wakes.  None of them makes another
+   system call on its own, so the process only ends, and its exit
+   status only reaches our parent, if the kernel gets each of them
+   out. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int never;
+static volatile int spin;
+
+static void
+spinner (void *aux UNUSED) 
+{
+  for (;;)
+    spin++;
+}
+
+static void
+joiner (void *aux) 
+{
+  uthread_join ((tid_t) (long) aux);
+  fail ("join of the spinning thread returned");
+}
+
+static void
+exiter (void *aux UNUSED) 
+{
+  msg ("exiting");
+  exit (57);
+}
+
+void
+test_main (void) 
+{
+  tid_t spin_tid = uthread_create (spinner, NULL);
+
+  CHECK (spin_tid != TID_ERROR, "start spinning thread");
+  CHECK (uthread_create (joiner, (void *) (long) spin_tid) != TID_ERROR,
+         "start joining thread");
+  if (uthread_create (exiter, NULL) == TID_ERROR)
+    fail ("uthread_create failed");
+
+  futex (&never, FUTEX_WAIT, 0);
+  fail ("futex wait returned");
+}
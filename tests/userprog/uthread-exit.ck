@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-exit) begin
+(uthread-exit) start spinning thread
+(uthread-exit) start joining thread
+(uthread-exit) exiting
+uthread-exit: exit(57)
+EOF
+pass;
@@ -0,0 +1,86 @@
+/* Starts several threads that share a counter, each adding to it
+   many times under a mutex built on futex(), and checks that no
+   update was lost.  The main thread then sleeps in FUTEX_WAIT
+   until the last thread to finish wakes it. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ITER_CNT 20000
+
+/* 0 if unlocked, 1 if locked, 2 if locked with waiters. */
+static int mutex;
+
+static int counter;
+static int finished;
+static int done_flag;
+
+static void
+mutex_lock (int *m) 
+{
+  int c = __sync_val_compare_and_swap (m, 0, 1);
+
+  if (c != 0) 
+    {
+      if (c != 2)
+        c = __sync_lock_test_and_set (m, 2);
+      while (c != 0) 
+        {
+          futex (m, FUTEX_WAIT, 2);
+          c = __sync_lock_test_and_set (m, 2);
+        }
+    }
+}
+
+static void
+mutex_unlock (int *m) 
+{
+  if (__sync_fetch_and_sub (m, 1) != 1) 
+    {
+      *m = 0;
+      futex (m, FUTEX_WAKE, 1);
+    }
+}
+
+static void
+adder (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ITER_CNT; i++) 
+    {
+      mutex_lock (&mutex);
+      counter++;
+      mutex_unlock (&mutex);
+    }
+
+  if (__sync_add_and_fetch (&finished, 1) == THREAD_CNT) 
+    {
+      done_flag = 1;
+      futex (&done_flag, FUTEX_WAKE, 1);
+    }
+}
+
+void
+test_main (void) 
+{
+  tid_t tids[THREAD_CNT];
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    if ((tids[i] = uthread_create (adder, NULL)) == TID_ERROR)
+      fail ("uthread_create %d failed", i);
+
+  while (done_flag == 0)
+    futex (&done_flag, FUTEX_WAIT, 0);
+  msg ("woken by the last thread");
+
+  for (i = 0; i < THREAD_CNT; i++)
+    if (uthread_join (tids[i]) != 0)
+      fail ("join of thread %d failed", i);
+  if (counter != THREAD_CNT * ITER_CNT)
+    fail ("counter is %d, not %d", counter, THREAD_CNT * ITER_CNT);
+  msg ("counter is %d", counter);
+}
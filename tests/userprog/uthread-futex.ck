@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-futex) begin
+(uthread-futex) woken by the last thread
+(uthread-futex) counter is 80000
+(uthread-futex) end
+uthread-futex: exit(0)
+EOF
+pass;
@@ -0,0 +1,54 @@
+/* Starts several threads, each of which ends with its own exit
+   status, either by returning or by calling uthread_exit(), and
+   joins them in reverse order.  Each join must return that
+   thread's status, a second join must return -1, as must joining
+   ourselves or a tid that is no thread of ours. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 5
+
+static int ran[THREAD_CNT];
+
+static void
+thread_func (void *aux) 
+{
+  int i = (int) (long) aux;
+
+  ran[i] = 1;
+  if (i != 0)
+    uthread_exit (i * 10);
+}
+
+void
+test_main (void) 
+{
+  tid_t tids[THREAD_CNT];
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      tids[i] = uthread_create (thread_func, (void *) (long) i);
+      if (tids[i] == TID_ERROR)
+        fail ("uthread_create %d failed", i);
+    }
+
+  for (i = THREAD_CNT - 1; i >= 0; i--) 
+    {
+      int status = uthread_join (tids[i]);
+      if (status != i * 10)
+        fail ("join of thread %d returned %d", i, status);
+      if (!ran[i])
+        fail ("thread %d did not run", i);
+    }
+  msg ("joined %d threads", THREAD_CNT);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    if (uthread_join (tids[i]) != -1)
+      fail ("second join of thread %d did not return -1", i);
+  msg ("second joins all returned -1");
+
+  CHECK (uthread_join (12345) == -1, "join of a bad tid returns -1");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-join) begin
+(uthread-join) joined 5 threads
+(uthread-join) second joins all returned -1
+(uthread-join) join of a bad tid returns -1
+(uthread-join) end
+uthread-join: exit(0)
+EOF
+pass;
@@ -0,0 +1,39 @@
+/* Forks many children, then waits for each of them, in the
+   reverse of the order they were forked in, and then again.
+   Each first wait must return that child's exit code, and each
+   second wait must return -1 immediately. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 20
+
+void
+test_main (void) 
+{
+  pid_t children[CHILD_CNT];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    {
+      children[i] = fork ("child");
+      if (children[i] == 0)
+        exit (i);
+      if (children[i] < 0)
+        fail ("fork child %d failed", i);
+    }
+
+  for (i = CHILD_CNT - 1; i >= 0; i--) 
+    {
+      int status = wait (children[i]);
+      if (status != i)
+        fail ("wait for child %d returned %d", i, status);
+    }
+  msg ("waited for %d children", CHILD_CNT);
+
+  for (i = 0; i < CHILD_CNT; i++)
+    if (wait (children[i]) != -1)
+      fail ("second wait for child %d did not return -1", i);
+  msg ("second waits all returned -1");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(wait-many) begin
+(wait-many) waited for 20 children
+(wait-many) second waits all returned -1
+(wait-many) end
+EOF
+pass;
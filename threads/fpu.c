@@ -0,0 +1,167 @@
+#include "threads/fpu.h"
+#include <debug.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* Control register bits.  See [IA32-v3a] 2.5 "Control
+   Registers". */
+#define CR0_MP 0x00000002       /* Monitor coprocessor. */
+#define CR0_EM 0x00000004       /* Emulation. */
+#define CR0_TS 0x00000008       /* Task switched. */
+#define CR4_OSFXSR 0x00000200   /* OS supports FXSAVE/FXRSTOR. */
+#define CR4_OSXMMEXCPT 0x00000400 /* OS handles #XF. */
+
+/* Thread whose state is in the FPU registers, or a null pointer
+   if they hold nothing worth saving. */
+static struct thread *fpu_owner;
+
+/* Whether CR0.TS is currently set.  Writing CR0 is slow, so we
+   only do it when this has to change. */
+static bool ts_set;
+
+/* FPU state right after FNINIT, loaded for a thread's first FPU
+   instruction. */
+static uint8_t fpu_initial[FPU_AREA_SIZE] __attribute__ ((aligned (16)));
+
+/* Statistics. */
+static long long trap_cnt;      /* # of #NM traps taken. */
+static long long save_cnt;      /* # of which had to save an owner. */
+
+static void fpu_trap (struct intr_frame *);
+static void set_ts (bool);
+
+/* Enables SSE, captures the initial FPU state, and arranges for
+   the first FPU instruction to trap.  Must be called after
+   intr_init() and before any user program runs. */
+void
+fpu_init (void) {
+	ASSERT (sizeof (struct thread) <= PGSIZE - FPU_AREA_SIZE);
+
+	lcr4 (rcr4 () | CR4_OSFXSR | CR4_OSXMMEXCPT);
+	lcr0 ((rcr0 () & ~CR0_EM) | CR0_MP);
+	clts ();
+	__asm __volatile ("fninit");
+	fxsave (fpu_initial);
+
+	fpu_owner = NULL;
+	ts_set = false;
+	set_ts (true);
+
+	intr_register_int (7, 0, INTR_OFF, fpu_trap,
+			"#NM Device Not Available Exception");
+}
+
+/* Gives T, a newly created thread, an FPU save area and marks it
+   as not yet having used the FPU. */
+void
+fpu_init_thread (struct thread *t) {
+	t->fpu_area = (uint8_t *) t + PGSIZE - FPU_AREA_SIZE;
+	t->fpu_used = false;
+}
+
+/* Called by schedule(), with interrupts off, just before NEXT is
+   switched in.  Lets NEXT use the FPU freely if its state is the
+   one loaded, and otherwise makes its first use trap. */
+void
+fpu_switch (struct thread *next) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	set_ts (fpu_owner != next);
+}
+
+/* Forgets the FPU state of T, which is exiting, so that it is
+   never saved into T's soon-to-be-freed save area. */
+void
+fpu_release (struct thread *t) {
+	enum intr_level old_level = intr_disable ();
+
+	if (fpu_owner == t)
+		fpu_owner = NULL;
+	t->fpu_used = false;
+	intr_set_level (old_level);
+}
+
+/* Copies SRC's FPU state into DST, as fork() requires.  SRC must
+   not be running. */
+void
+fpu_copy (struct thread *dst, struct thread *src) {
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (dst->fpu_area != NULL);
+
+	if (src->fpu_used) {
+		if (fpu_owner == src) {
+			/* SRC's latest state is still in the registers. */
+			clts ();
+			fxsave (src->fpu_area);
+			fpu_owner = NULL;
+			ts_set = false;
+			set_ts (true);
+		}
+		memcpy (dst->fpu_area, src->fpu_area, FPU_AREA_SIZE);
+	}
+	dst->fpu_used = src->fpu_used;
+	intr_set_level (old_level);
+}
+
+/* Discards the running thread's FPU state, so that its next FPU
+   instruction starts from the initial state, as exec() requires. */
+void
+fpu_reset (void) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	if (fpu_owner == t)
+		fpu_owner = NULL;
+	t->fpu_used = false;
+	set_ts (true);
+	intr_set_level (old_level);
+}
+
+/* Prints FPU statistics. */
+void
+fpu_print_stats (void) {
+	printf ("FPU: %lld lazy restores, %lld saves\n", trap_cnt, save_cnt);
+}
+
+/* #NM handler.  Saves the previous owner's registers, if any, and
+   loads the running thread's. */
+static void
+fpu_trap (struct intr_frame *f UNUSED) {
+	struct thread *t = thread_current ();
+
+	clts ();
+	ts_set = false;
+	trap_cnt++;
+	if (fpu_owner == t)
+		return;
+
+	if (t->fpu_area == NULL)
+		PANIC ("thread `%s' used the FPU but has no save area", t->name);
+
+	if (fpu_owner != NULL) {
+		fxsave (fpu_owner->fpu_area);
+		save_cnt++;
+	}
+	fxrstor (t->fpu_used ? t->fpu_area : fpu_initial);
+	t->fpu_used = true;
+	fpu_owner = t;
+}
+
+/* Sets CR0.TS if SET, or clears it otherwise, unless it already
+   has that value. */
+static void
+set_ts (bool set) {
+	if (set == ts_set)
+		return;
+	if (set)
+		lcr0 (rcr0 () | CR0_TS);
+	else
+		clts ();
+	ts_set = set;
+}
@@ -13,6 +13,7 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "devices/vga.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
@@ -21,6 +22,7 @@
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -94,6 +96,7 @@ main (void) {
 
 	/* Initialize interrupt handlers. */
 	intr_init ();
+	fpu_init ();
 	timer_init ();
 	kbd_init ();
 	input_init ();
@@ -105,6 +108,7 @@ main (void) {
 	thread_start ();
 	serial_init_queue ();
 	timer_calibrate ();
+	workqueue_init (&system_wq, "kworker", PRI_DEFAULT, 2);
 
 #ifdef FILESYS
 	/* Initialize file system. */
@@ -221,6 +225,14 @@ parse_options (char **argv) {
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-fair"))
+			thread_fair = true;
+		else if (!strcmp (name, "-ready-list"))
+			thread_ready_list = true;
+		else if (!strcmp (name, "-tickless"))
+			timer_tickless = true;
+		else if (!strcmp (name, "-intr-trace"))
+			intr_trace = true;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -231,6 +243,9 @@ parse_options (char **argv) {
 			PANIC ("unknown option `%s' (use -h for help)", name);
 	}
 
+	if (thread_mlfqs && thread_fair)
+		PANIC ("-mlfqs and -fair are mutually exclusive");
+
 	return argv;
 }
 
@@ -326,6 +341,10 @@ usage (void) {
 			"  -f                 Format file system disk during startup.\n"
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -fair              Use fair-share scheduler, weighted by nice.\n"
+			"  -ready-list        Use one ordered ready list, not per-priority queues.\n"
+			"  -tickless          Stop the periodic timer interrupt while idle.\n"
+			"  -intr-trace        Time how long interrupts stay off.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -354,6 +373,9 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	lock_print_stats ();
+	intr_print_stats ();
+	workqueue_print_stats (&system_wq);
 #ifdef FILESYS
 	disk_print_stats ();
 #endif
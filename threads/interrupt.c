@@ -13,6 +13,7 @@
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/gdt.h"
+#include "userprog/process.h"
 #endif
 
 /* Number of x86_64 interrupts. */
@@ -103,6 +104,43 @@ static const char *intr_names[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Interrupts-off latency tracing.
+
+   With -intr-trace, each span of time that interrupts are off is
+   timed with the TSC, from the intr_disable() or intr_set_level()
+   call, or the external interrupt, that turned them off, to the
+   call or interrupt return that turned them back on.  A span may
+   begin in one thread and end in another, as when a thread turns
+   interrupts off and blocks, and is charged to where it began: the
+   caller's return address, or the handler of an external
+   interrupt.  The longest span from each of the INTR_TRACE_TOP
+   worst places is kept for intr_print_stats().
+
+   idle() turns interrupts on with a bare "sti", so it calls
+   intr_trace_sti() first.  A span ended by any other bare sti or
+   by an iretq, such as the switch to a new user process, cannot be
+   seen, and is dropped when the next interrupt finds interrupts
+   were on. */
+#define INTR_TRACE_TOP 8
+
+/* Longest interrupts-off span that began at one place. */
+struct intr_span {
+	const void *where;              /* Caller or handler. */
+	const char *name;               /* Interrupt's name, or null. */
+	uint64_t cycles;                /* Length in TSC cycles. */
+};
+
+bool intr_trace;
+
+static bool span_open;                  /* Timing a span now? */
+static struct intr_span span;           /* The span being timed. */
+static uint64_t span_start;             /* TSC when it began. */
+static struct intr_span top_spans[INTR_TRACE_TOP];
+static long long span_cnt;              /* # of spans timed. */
+
+static void trace_begin (const void *where, const char *name);
+static void trace_end (void);
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -128,7 +166,8 @@ intr_get_level (void) {
    returns the previous interrupt status. */
 enum intr_level
 intr_set_level (enum intr_level level) {
-	return level == INTR_ON ? intr_enable () : intr_disable ();
+	return level == INTR_ON ? intr_enable ()
+		: intr_disable_at (__builtin_return_address (0));
 }
 
 /* Enables interrupts and returns the previous interrupt status. */
@@ -141,6 +180,8 @@ intr_enable (void) {
 
 	   See [IA32-v2b] "STI" and [IA32-v3a] 5.8.1 "Masking Maskable
 	   Hardware Interrupts". */
+	if (old_level == INTR_OFF && intr_trace)
+		trace_end ();
 	asm volatile ("sti");
 
 	return old_level;
@@ -149,6 +190,16 @@ intr_enable (void) {
 /* Disables interrupts and returns the previous interrupt status. */
 enum intr_level
 intr_disable (void) {
+	return intr_disable_at (__builtin_return_address (0));
+}
+
+/* Disables interrupts on behalf of CALLER, to whom an
+   interrupts-off span that starts here is attributed, and returns
+   the previous interrupt status.  For wrappers such as
+   spinlock_acquire() that would otherwise be blamed for every
+   span they open. */
+enum intr_level
+intr_disable_at (const void *caller) {
 	enum intr_level old_level = intr_get_level ();
 
 	/* Disable interrupts by clearing the interrupt flag.
@@ -156,9 +207,93 @@ intr_disable (void) {
 	   Hardware Interrupts". */
 	asm volatile ("cli" : : : "memory");
 
+	if (old_level == INTR_ON && intr_trace)
+		trace_begin (caller, NULL);
 	return old_level;
 }
 
+/* Ends the interrupts-off span, if any, because interrupts are
+   about to be turned on by other means than intr_enable().
+   Interrupts must be off. */
+void
+intr_trace_sti (void) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (intr_trace)
+		trace_end ();
+}
+
+/* Prints the longest interrupts-off spans, if they were timed.
+   Addresses can be turned into function names with the
+   `backtrace' tool. */
+void
+intr_print_stats (void) {
+	struct intr_span top[INTR_TRACE_TOP];
+	enum intr_level old_level;
+	int cnt = 0;
+
+	if (!intr_trace)
+		return;
+
+	/* Copy the spans out, longest first. */
+	old_level = intr_disable ();
+	for (int i = 0; i < INTR_TRACE_TOP; i++) {
+		int j;
+
+		if (top_spans[i].cycles == 0)
+			continue;
+		for (j = cnt; j > 0 && top[j - 1].cycles < top_spans[i].cycles; j--)
+			top[j] = top[j - 1];
+		top[j] = top_spans[i];
+		cnt++;
+	}
+	intr_set_level (old_level);
+
+	printf ("Interrupts off: %lld spans, longest:\n", span_cnt);
+	for (int i = 0; i < cnt; i++)
+		if (top[i].name != NULL)
+			printf ("  %12"PRIu64" cycles in %p (%s)\n",
+					top[i].cycles, top[i].where, top[i].name);
+		else
+			printf ("  %12"PRIu64" cycles from %p\n",
+					top[i].cycles, top[i].where);
+}
+
+/* Starts timing an interrupts-off span that began at WHERE, named
+   NAME if it is an interrupt. */
+static void
+trace_begin (const void *where, const char *name) {
+	span.where = where;
+	span.name = name;
+	span_start = rdtsc ();
+	span_open = true;
+}
+
+/* Ends the interrupts-off span being timed, if any, and keeps it
+   if it is among the longest. */
+static void
+trace_end (void) {
+	struct intr_span *slot = NULL;
+
+	if (!span_open)
+		return;
+	span_open = false;
+	span.cycles = rdtsc () - span_start;
+	span_cnt++;
+
+	/* Use WHERE's slot if it has one, or else the shortest. */
+	for (int i = 0; i < INTR_TRACE_TOP; i++) {
+		if (top_spans[i].where == span.where) {
+			slot = &top_spans[i];
+			break;
+		}
+		if (slot == NULL || top_spans[i].cycles < slot->cycles)
+			slot = &top_spans[i];
+	}
+	if (span.cycles > slot->cycles)
+		*slot = span;
+}
+
 /* Initializes the interrupt system. */
 void
 intr_init (void) {
@@ -252,6 +387,17 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
 	register_handler (vec_no, dpl, level, handler, name);
 }
 
+/* Makes interrupt VEC_NO, which must already be registered, run
+   on the stack in interrupt stack table entry IST (1 to 7) of the
+   TSS, whatever stack was in use when it occurred.  See [IA32-v3a]
+   6.14.5 "Interrupt Stack Table". */
+void
+intr_set_ist (uint8_t vec_no, unsigned ist) {
+	ASSERT (intr_handlers[vec_no] != NULL);
+	ASSERT (ist >= 1 && ist <= 7);
+	idt[vec_no].ist = ist;
+}
+
 /* Returns true during processing of an external interrupt
    and false at all other times. */
 bool
@@ -338,6 +484,18 @@ intr_handler (struct intr_frame *frame) {
 	   and they need to be acknowledged on the PIC (see below).
 	   An external interrupt handler cannot sleep. */
 	external = frame->vec_no >= 0x20 && frame->vec_no < 0x30;
+	handler = intr_handlers[frame->vec_no];
+
+	/* Interrupts were on when this one arrived, so whatever span
+	   was being timed was ended without our seeing it.  An external
+	   interrupt's handler starts a span of its own. */
+	if ((frame->eflags & FLAG_IF) && intr_trace) {
+		span_open = false;
+		if (external)
+			trace_begin ((const void *) handler,
+					intr_names[frame->vec_no]);
+	}
+
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
 		ASSERT (!intr_context ());
@@ -347,7 +505,6 @@ intr_handler (struct intr_frame *frame) {
 	}
 
 	/* Invoke the interrupt's handler. */
-	handler = intr_handlers[frame->vec_no];
 	if (handler != NULL)
 		handler (frame);
 	else if (frame->vec_no == 0x27 || frame->vec_no == 0x2f) {
@@ -371,6 +528,20 @@ intr_handler (struct intr_frame *frame) {
 
 		if (yield_on_return)
 			thread_yield ();
+
+		/* Returning turns interrupts back on. */
+		if (intr_trace)
+			trace_end ();
+
+#ifdef USERPROG
+		/* A thread running user code when another thread of its
+		   process called exit() would not make another system call
+		   to notice. */
+		if (frame->cs == SEL_UCSEG && process_exiting ()) {
+			intr_enable ();
+			thread_exit ();
+		}
+#endif
 	}
 }
 
@@ -0,0 +1,135 @@
+#include "threads/kstack.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/init.h"
+#include "threads/mmu.h"
+#include "threads/objcache.h"
+#include "threads/palloc.h"
+#include "threads/pte.h"
+#include "intrinsic.h"
+
+/* Byte that fills the unused part of a fresh stack, so that
+   kstack_used() can tell how deep the stack ever got. */
+#define KSTACK_POISON 0xa5
+
+/* Offset and size of the stack proper within a region. */
+#define STACK_OFS (2 * PGSIZE)
+#define STACK_SIZE (KSTACK_SIZE - STACK_OFS)
+
+/* Freed stacks are kept, guard page still unmapped and stack
+   freshly poisoned, for reuse by the next kstack_alloc(), up to
+   KSTACK_CACHE_MAX of them.  This saves a trip through palloc and
+   two page table updates for each thread created, and only the
+   part of the stack that was used has to be poisoned again. */
+#define KSTACK_CACHE_MAX 16
+static struct objcache kstack_cache;
+
+static size_t max_used;         /* Deepest any freed stack got, in bytes. */
+
+static void *kstack_create (void);
+static void kstack_destroy (void *);
+static void set_guard (void *, bool present);
+
+/* Initializes the kernel stack allocator. */
+void
+kstack_init (void) {
+	objcache_init (&kstack_cache, "Kernel stack", KSTACK_CACHE_MAX,
+			kstack_create, kstack_destroy);
+}
+
+/* Returns a KSTACK_SIZE region, aligned to KSTACK_SIZE, whose
+   second page is the guard page.  The first page, where struct
+   thread goes, is not cleared; init_thread() does that for the
+   part it uses.  Returns a null pointer if memory is exhausted. */
+void *
+kstack_alloc (void) {
+	return objcache_get (&kstack_cache);
+}
+
+/* Frees STACK, which must have been returned by kstack_alloc().
+   May be called with interrupts off. */
+void
+kstack_free (void *stack) {
+	size_t used;
+
+	ASSERT (stack != NULL);
+	ASSERT ((uintptr_t) stack % KSTACK_SIZE == 0);
+
+	used = kstack_used (stack);
+	if (used > max_used)
+		max_used = used;
+	memset ((uint8_t *) stack + KSTACK_SIZE - used, KSTACK_POISON, used);
+	objcache_put (&kstack_cache, stack);
+}
+
+/* Returns the number of bytes of STACK that have ever been used,
+   its high-water mark, judged by how much of the poison written
+   by kstack_alloc() has been overwritten. */
+size_t
+kstack_used (const void *stack) {
+	const uint64_t *p = (const uint64_t *) ((const uint8_t *) stack + STACK_OFS);
+	const uint64_t *end = (const uint64_t *) ((const uint8_t *) stack + KSTACK_SIZE);
+	uint64_t poison;
+
+	memset (&poison, KSTACK_POISON, sizeof poison);
+	while (p < end && *p == poison)
+		p++;
+	return (const uint8_t *) end - (const uint8_t *) p;
+}
+
+/* Prints kernel stack statistics. */
+void
+kstack_print_stats (void) {
+	objcache_print_stats (&kstack_cache);
+	printf ("Kernel stacks: deepest %zu of %d bytes\n", max_used, STACK_SIZE);
+}
+
+/* Allocates a new stack region for kstack_cache: KSTACK_PAGES
+   pages aligned to KSTACK_SIZE, with the guard page unmapped and
+   the stack poisoned.  Allocates enough pages that an aligned run
+   must be among them and gives back the rest. */
+static void *
+kstack_create (void) {
+	const size_t page_cnt = 2 * KSTACK_PAGES - 1;
+	uint8_t *pages, *stack;
+	size_t head;
+
+	pages = palloc_get_multiple (0, page_cnt);
+	if (pages == NULL)
+		return NULL;
+
+	stack = (uint8_t *) ROUND_UP ((uintptr_t) pages, KSTACK_SIZE);
+	head = (stack - pages) / PGSIZE;
+	palloc_free_multiple (pages, head);
+	palloc_free_multiple (stack + KSTACK_SIZE, page_cnt - head - KSTACK_PAGES);
+
+	set_guard (stack, false);
+	memset (stack + STACK_OFS, KSTACK_POISON, STACK_SIZE);
+	return stack;
+}
+
+/* Frees STACK, for which kstack_cache has no room. */
+static void
+kstack_destroy (void *stack) {
+	set_guard (stack, true);
+	palloc_free_multiple (stack, KSTACK_PAGES);
+}
+
+/* Maps STACK's guard page if PRESENT is true, unmaps it
+   otherwise.  Kernel page tables are shared by every address
+   space, so this takes effect everywhere. */
+static void
+set_guard (void *stack, bool present) {
+	uint64_t guard = (uint64_t) stack + PGSIZE;
+	uint64_t *pte = pml4e_walk (base_pml4, guard, 0);
+
+	ASSERT (pte != NULL);
+	if (present)
+		*pte |= PTE_P;
+	else
+		*pte &= ~(uint64_t) PTE_P;
+	invlpg (guard);
+}
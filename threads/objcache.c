@@ -0,0 +1,76 @@
+#include "threads/objcache.h"
+#include <debug.h>
+#include <stdio.h>
+
+/* A cached object, overlaid on its first word. */
+struct objcache_link {
+	struct objcache_link *next;
+};
+
+/* Initializes C as an empty cache named NAME that holds at most
+   MAX_CNT objects, allocated with ALLOC and freed with FREE. */
+void
+objcache_init (struct objcache *c, const char *name, size_t max_cnt,
+		objcache_alloc_func *alloc, objcache_free_func *free) {
+	ASSERT (c != NULL);
+	ASSERT (alloc != NULL);
+	ASSERT (free != NULL);
+
+	c->name = name;
+	c->max_cnt = max_cnt;
+	c->alloc = alloc;
+	c->free = free;
+	spinlock_init (&c->lock);
+	c->objs = NULL;
+	c->cnt = 0;
+	c->get_cnt = 0;
+	c->hit_cnt = 0;
+}
+
+/* Returns an initialized object from C, taking a cached one if
+   there is any and allocating a new one otherwise.  Returns a
+   null pointer if memory is exhausted. */
+void *
+objcache_get (struct objcache *c) {
+	struct objcache_link *obj;
+
+	spinlock_acquire (&c->lock);
+	obj = c->objs;
+	if (obj != NULL) {
+		c->objs = obj->next;
+		c->cnt--;
+		c->hit_cnt++;
+	}
+	c->get_cnt++;
+	spinlock_release (&c->lock);
+
+	return obj != NULL ? obj : c->alloc ();
+}
+
+/* Returns OBJ, which must be in its initial state, to C.  If C is
+   full, OBJ is freed instead. */
+void
+objcache_put (struct objcache *c, void *obj_) {
+	struct objcache_link *obj = obj_;
+
+	ASSERT (obj != NULL);
+
+	spinlock_acquire (&c->lock);
+	if (c->cnt < c->max_cnt) {
+		obj->next = c->objs;
+		c->objs = obj;
+		c->cnt++;
+		obj = NULL;
+	}
+	spinlock_release (&c->lock);
+
+	if (obj != NULL)
+		c->free (obj);
+}
+
+/* Prints statistics for C. */
+void
+objcache_print_stats (struct objcache *c) {
+	printf ("%s cache: %lld allocated, %lld from cache, %zu cached\n",
+			c->name, c->get_cnt, c->hit_cnt, c->cnt);
+}
@@ -39,7 +39,8 @@ static struct pool kernel_pool, user_pool;
 /* Maximum number of pages to put in user pool. */
 size_t user_page_limit = SIZE_MAX;
 static void
-init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
+init_pool (struct pool *p, const char *name, void **bm_base, uint64_t start,
+		uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
 
@@ -158,7 +159,7 @@ populate_pools (struct area *base_mem, struct area *ext_mem) {
 						break;
 					}
 					// generate kernel pool
-					init_pool (&kernel_pool,
+					init_pool (&kernel_pool, "kernel pool",
 							&free_start, region_start, start + rem * PGSIZE);
 					// Transition to the next state
 					if (rem == size_in_pg) {
@@ -188,7 +189,7 @@ populate_pools (struct area *base_mem, struct area *ext_mem) {
 	}
 
 	// generate the user pool
-	init_pool(&user_pool, &free_start, region_start, end);
+	init_pool(&user_pool, "user pool", &free_start, region_start, end);
 
 	// Iterate over the e820_entry. Setup the usable.
 	uint64_t usable_bound = (uint64_t) free_start;
@@ -333,9 +334,11 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
-/* Initializes pool P as starting at START and ending at END */
+/* Initializes pool P, named NAME, as starting at START and ending
+   at END */
 static void
-init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
+init_pool (struct pool *p, const char *name, void **bm_base, uint64_t start,
+		uint64_t end) {
   /* We'll put the pool's used_map at its base.
      Calculate the space needed for the bitmap
      and subtract it from the pool's size. */
@@ -343,6 +346,7 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
 	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
 
 	lock_init(&p->lock);
+	lock_set_name (&p->lock, name);
 	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
 	p->base = (void *) start;
 
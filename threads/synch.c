@@ -27,10 +27,26 @@
    */
 
 #include "threads/synch.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+/* A thread waiting in sema_down_timeout(). */
+struct sema_waiter {
+	struct timeout timeout;         /* Ends the wait when it expires. */
+	struct thread *thread;          /* The waiting thread. */
+};
+
+static rbtree_less_func waiter_less;
+static timeout_func sema_timeout;
+static rbtree_less_func cond_waiter_less;
+static void lockstat_acquired (struct lock *, bool contended,
+		uint64_t wait_start);
+static void lockstat_released (struct lock *);
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -46,7 +62,7 @@ sema_init (struct semaphore *sema, unsigned value) {
 	ASSERT (sema != NULL);
 
 	sema->value = value;
-	list_init (&sema->waiters);
+	rbtree_init (&sema->waiters, waiter_less, NULL);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -57,9 +73,9 @@ sema_init (struct semaphore *sema, unsigned value) {
    interrupts disabled, but if it sleeps then the next scheduled
    thread will probably turn interrupts back on. This is
    sema_down function. */
-// * 함수 수정
 void
 sema_down (struct semaphore *sema) {
+	struct thread *cur = thread_current ();
 	enum intr_level old_level;
 
 	ASSERT (sema != NULL);
@@ -67,14 +83,65 @@ sema_down (struct semaphore *sema) {
 
 	old_level = intr_disable ();
 	while (sema->value == 0) {
-    // * Semaphore를 얻고 waiters 리스트 삽입 시, 우선순위대로 삽입되도록 수정
-    list_insert_ordered(&sema->waiters, &thread_current() ->elem, cmp_priority, NULL);
+		cur->wait_on_sema = sema;
+		rbtree_insert (&sema->waiters, &cur->sema_elem);
 		thread_block ();
 	}
 	sema->value--;
 	intr_set_level (old_level);
 }
 
+/* Down or "P" operation on a semaphore, as sema_down(), but waits
+   for at most TICKS timer ticks.  Returns true if the semaphore is
+   decremented, false if the time ran out first.  If TICKS is 0 or
+   less, does not wait at all, like sema_try_down().
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+sema_down_timeout (struct semaphore *sema, int64_t ticks) {
+	struct sema_waiter w;
+	enum intr_level old_level;
+	bool success;
+
+	ASSERT (sema != NULL);
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	if (sema->value == 0 && ticks > 0) {
+		w.thread = thread_current ();
+		timeout_init (&w.timeout, sema_timeout);
+		timeout_add (&w.timeout, timer_ticks () + ticks);
+		while (sema->value == 0 && timeout_pending (&w.timeout)) {
+			w.thread->wait_on_sema = sema;
+			rbtree_insert (&sema->waiters, &w.thread->sema_elem);
+			thread_block ();
+		}
+		timeout_cancel (&w.timeout);
+	}
+	success = sema->value > 0;
+	if (success)
+		sema->value--;
+	intr_set_level (old_level);
+	return success;
+}
+
+/* Timeout function for sema_down_timeout(): takes the waiting
+   thread off the semaphore's waiters and wakes it, unless
+   sema_up() already has. */
+static void
+sema_timeout (struct timeout *timeout) {
+	struct thread *t = timeout_entry (timeout, struct sema_waiter,
+			timeout)->thread;
+
+	if (t->wait_on_sema != NULL) {
+		rbtree_remove (&t->wait_on_sema->waiters, &t->sema_elem);
+		t->wait_on_sema = NULL;
+		thread_unblock (t);
+		test_max_priority ();
+	}
+}
+
 /* Down or "P" operation on a semaphore, but only if the
    semaphore is not already 0.  Returns true if the semaphore is
    decremented, false otherwise.
@@ -104,7 +171,6 @@ sema_try_down (struct semaphore *sema) {
    and wakes up one thread of those waiting for SEMA, if any.
 
    This function may be called from an interrupt handler. */
-// * 함수 수정
 void
 sema_up (struct semaphore *sema) {
 	enum intr_level old_level;
@@ -112,14 +178,14 @@ sema_up (struct semaphore *sema) {
 	ASSERT (sema != NULL);
 
 	old_level = intr_disable ();
-	if (!list_empty (&sema->waiters)) {
-    // * waiter list에 있는 우선순위가 변경 되었을 경우를 고려하여 waiter list를 정렬
-
-    list_sort(&sema->waiters, cmp_priority, NULL);
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-					struct thread, elem));
+	if (!rbtree_empty (&sema->waiters)) {
+		struct thread *t = rbtree_entry (rbtree_min (&sema->waiters),
+				struct thread, sema_elem);
 
-  }
+		rbtree_remove (&sema->waiters, &t->sema_elem);
+		t->wait_on_sema = NULL;
+		thread_unblock (t);
+	}
 	sema->value++;
   // * Semaphore 해제 후 priority preemption 기능 추가
   test_max_priority();
@@ -127,23 +193,54 @@ sema_up (struct semaphore *sema) {
 	intr_set_level (old_level);
 }
 
-bool
-cmp_sem_priority(const struct list_elem *a, const struct list_elem *b, void *aux UNUSED) {
-  struct semaphore_elem *sa = list_entry(a, struct semaphore_elem, elem);
-  struct semaphore_elem *sb = list_entry(b, struct semaphore_elem, elem);
-  
-  struct list *la = &(sa->semaphore.waiters);
-  struct list *lb = &(sb->semaphore.waiters);
+/* Orders a semaphore's waiting threads by descending priority. */
+static bool
+waiter_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = rbtree_entry (a_, struct thread, sema_elem);
+	const struct thread *b = rbtree_entry (b_, struct thread, sema_elem);
 
-  struct list_elem *lea = list_begin(la);
-  struct list_elem *leb = list_begin(lb);
+	return a->priority > b->priority;
+}
 
-  struct thread *ta = list_entry(lea, struct thread, elem);
-  struct thread *tb = list_entry(leb, struct thread, elem);
+/* Orders a condition variable's waiters by descending priority. */
+static bool
+cond_waiter_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct semaphore_elem *a
+		= rbtree_entry (a_, struct semaphore_elem, elem);
+	const struct semaphore_elem *b
+		= rbtree_entry (b_, struct semaphore_elem, elem);
 
-  if (tb->priority < ta->priority)
-    return 1;
-  return 0;
+	return a->thread->priority > b->thread->priority;
+}
+
+/* Takes T out of the waiters of the semaphore and condition
+   variable it is waiting for, if any, so that its priority can be
+   changed.  synch_requeue() must be called after the change to
+   put it back in its new place.  thread.c does so around every
+   change to the priority of a thread that might be waiting.
+   Interrupts must be off. */
+void
+synch_unqueue (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (t->wait_on_sema != NULL)
+		rbtree_remove (&t->wait_on_sema->waiters, &t->sema_elem);
+	if (t->cond_waiter != NULL)
+		rbtree_remove (&t->cond_waiter->cond->waiters, &t->cond_waiter->elem);
+}
+
+/* Puts T back where synch_unqueue() took it from, in the place
+   that its priority now gives it.  Interrupts must be off. */
+void
+synch_requeue (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (t->wait_on_sema != NULL)
+		rbtree_insert (&t->wait_on_sema->waiters, &t->sema_elem);
+	if (t->cond_waiter != NULL)
+		rbtree_insert (&t->cond_waiter->cond->waiters, &t->cond_waiter->elem);
 }
 
 
@@ -203,6 +300,8 @@ lock_init (struct lock *lock) {
 
 	lock->holder = NULL;
 	sema_init (&lock->semaphore, 1);
+	donation_init (lock);
+	lock->stats = NULL;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -215,25 +314,70 @@ lock_init (struct lock *lock) {
    we need to sleep. */
 void
 lock_acquire (struct lock *lock) {
+	uint64_t wait_start = 0;
+	bool contended;
+
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (!lock_held_by_current_thread (lock));
 
+	contended = lock->holder != NULL;
+	if (contended && lock->stats != NULL)
+		wait_start = rdtsc ();
+
   if(!thread_mlfqs) {
-    if (lock->holder != NULL) {
-      struct thread *cur = thread_current();
-      cur->wait_on_lock = lock;
-      list_push_back(&lock->holder->donations, &cur->donation_elem);
-      donate_priority();
-    }
+    if (contended)
+      donation_wait (lock);
 
     sema_down (&lock->semaphore);
-    thread_current()->wait_on_lock = NULL;
     lock->holder = thread_current();
+    donation_acquire (lock);
   } else {
     sema_down (&lock->semaphore);
     lock->holder = thread_current();
   }
+
+	if (lock->stats != NULL)
+		lockstat_acquired (lock, contended, wait_start);
+}
+
+/* Acquires LOCK like lock_acquire(), but waits for at most TICKS
+   timer ticks.  Returns true if LOCK was acquired, false if the
+   time ran out first, in which case any priority we donated while
+   waiting is taken back.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+lock_acquire_timeout (struct lock *lock, int64_t ticks) {
+	uint64_t wait_start = 0;
+	bool contended;
+
+	ASSERT (lock != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (!lock_held_by_current_thread (lock));
+
+	if (ticks <= 0)
+		return lock_try_acquire (lock);
+
+	contended = lock->holder != NULL;
+	if (contended && lock->stats != NULL)
+		wait_start = rdtsc ();
+
+	if (contended && !thread_mlfqs)
+		donation_wait (lock);
+	if (!sema_down_timeout (&lock->semaphore, ticks)) {
+		if (!thread_mlfqs)
+			donation_cancel (lock);
+		return false;
+	}
+	lock->holder = thread_current ();
+	if (!thread_mlfqs)
+		donation_acquire (lock);
+
+	if (lock->stats != NULL)
+		lockstat_acquired (lock, contended, wait_start);
+	return true;
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -250,8 +394,13 @@ lock_try_acquire (struct lock *lock) {
 	ASSERT (!lock_held_by_current_thread (lock));
 
 	success = sema_try_down (&lock->semaphore);
-	if (success)
+	if (success) {
 		lock->holder = thread_current ();
+		if (!thread_mlfqs)
+			donation_acquire (lock);
+		if (lock->stats != NULL)
+			lockstat_acquired (lock, false, 0);
+	}
 	return success;
 }
 
@@ -266,11 +415,11 @@ lock_release (struct lock *lock) {
 	ASSERT (lock != NULL);
 	ASSERT (lock_held_by_current_thread (lock));
 
+	if (lock->stats != NULL)
+		lockstat_released (lock);
+  if (!thread_mlfqs)
+    donation_release (lock);
 	lock->holder = NULL;
-  if (!thread_mlfqs) {
-    remove_with_lock(lock);
-    refresh_priority();
-  }
 	sema_up (&lock->semaphore);
 }
 
@@ -283,8 +432,399 @@ lock_held_by_current_thread (const struct lock *lock) {
 
 	return lock->holder == thread_current ();
 }
+
+/* Lock statistics.
+
+   A lock named with lock_set_name() points to the statistics kept
+   for its name, and updates them on each acquisition and release
+   at the cost of reading the time-stamp counter and a few atomic
+   additions.  Locks that share a name may be held at once on
+   different CPUs, so the updates must be atomic even though the
+   updater holds a lock.  A lock with no name pays only for a test
+   of its `stats' member. */
+
+/* Statistics for each name, in order of first use. */
+static struct lockstat lockstats[LOCKSTAT_MAX];
+static size_t lockstat_cnt;
+
+/* Protects lockstat_cnt and the names in lockstats.  A spinlock
+   that is all zeros is released, so this one needs no
+   initialization and may be used before anything else runs. */
+static struct spinlock lockstat_lock;
+
+/* Most locks lock_print_stats() reports. */
+#define LOCKSTAT_PRINT_TOP 8
+
+/* Keeps statistics for LOCK from now on, under NAME, which must
+   be at most LOCKSTAT_NAME_LEN characters long.  Locks given the
+   same name are counted together.  If LOCKSTAT_MAX names are
+   already in use, LOCK is left unnamed. */
+void
+lock_set_name (struct lock *lock, const char *name) {
+	struct lockstat *s = NULL;
+
+	ASSERT (lock != NULL);
+	ASSERT (name != NULL && strlen (name) <= LOCKSTAT_NAME_LEN);
+
+	spinlock_acquire (&lockstat_lock);
+	for (size_t i = 0; i < lockstat_cnt; i++)
+		if (!strcmp (lockstats[i].name, name)) {
+			s = &lockstats[i];
+			break;
+		}
+	if (s == NULL && lockstat_cnt < LOCKSTAT_MAX) {
+		s = &lockstats[lockstat_cnt++];
+		strlcpy (s->name, name, sizeof s->name);
+	}
+	spinlock_release (&lockstat_lock);
+
+	lock->acquired_at = rdtsc ();
+	lock->stats = s;
+}
+
+/* Copies the statistics for up to CNT lock names into TOP, most
+   total time waited first, and returns the number copied.  Names
+   whose locks have never been acquired are left out. */
+size_t
+lock_stats_top (struct lockstat *top, size_t cnt) {
+	size_t n = 0;
+
+	spinlock_acquire (&lockstat_lock);
+	for (size_t i = 0; i < lockstat_cnt; i++) {
+		const struct lockstat *s = &lockstats[i];
+		size_t j;
+
+		if (s->acquire_cnt == 0)
+			continue;
+		for (j = n; j > 0 && top[j - 1].wait_cycles < s->wait_cycles; j--)
+			if (j < cnt)
+				top[j] = top[j - 1];
+		if (j < cnt) {
+			top[j] = *s;
+			if (n < cnt)
+				n++;
+		}
+	}
+	spinlock_release (&lockstat_lock);
+	return n;
+}
+
+/* Prints statistics for the most waited-for locks. */
+void
+lock_print_stats (void) {
+	struct lockstat top[LOCKSTAT_PRINT_TOP];
+	size_t cnt = lock_stats_top (top, LOCKSTAT_PRINT_TOP);
+
+	if (cnt == 0)
+		return;
+	printf ("Locks, most waited for first:\n");
+	for (size_t i = 0; i < cnt; i++)
+		printf ("  %-15s %"PRIu64" acquired, %"PRIu64" contended, "
+				"%"PRIu64" cycles waiting, longest hold %"PRIu64" cycles\n",
+				top[i].name, top[i].acquire_cnt, top[i].contended_cnt,
+				top[i].wait_cycles, top[i].hold_max);
+}
+
+/* Records that the current thread has just acquired LOCK, which
+   has statistics, having waited since WAIT_START if CONTENDED. */
+static void
+lockstat_acquired (struct lock *lock, bool contended, uint64_t wait_start) {
+	struct lockstat *s = lock->stats;
+	uint64_t now = rdtsc ();
+
+	xaddq (&s->acquire_cnt, 1);
+	if (contended) {
+		xaddq (&s->contended_cnt, 1);
+		xaddq (&s->wait_cycles, now - wait_start);
+	}
+	lock->acquired_at = now;
+}
+
+/* Records that the current thread is about to release LOCK, which
+   has statistics. */
+static void
+lockstat_released (struct lock *lock) {
+	struct lockstat *s = lock->stats;
+	uint64_t held = rdtsc () - lock->acquired_at;
+	uint64_t max = s->hold_max;
+
+	while (held > max) {
+		uint64_t seen = cmpxchgq (&s->hold_max, max, held);
+		if (seen == max)
+			break;
+		max = seen;
+	}
+}
 
 
+/* Initializes spinlock L as released. */
+void
+spinlock_init (struct spinlock *l) {
+	ASSERT (l != NULL);
+
+	l->next = l->owner = 0;
+	l->old_level = INTR_OFF;
+}
+
+/* Acquires spinlock L, busy-waiting until it is our turn.
+   Interrupts are disabled until the matching spinlock_release(),
+   so this may be called from an interrupt handler. */
+void
+spinlock_acquire (struct spinlock *l) {
+	enum intr_level old_level;
+	uint32_t ticket;
+
+	ASSERT (l != NULL);
+
+	old_level = intr_disable_at (__builtin_return_address (0));
+	ticket = xaddl (&l->next, 1);
+	while (l->owner != ticket)
+		cpu_relax ();
+	l->old_level = old_level;
+}
+
+/* Releases spinlock L and restores the interrupt level from
+   before it was acquired. */
+void
+spinlock_release (struct spinlock *l) {
+	enum intr_level old_level;
+
+	ASSERT (spinlock_held (l));
+
+	/* Only the holder writes owner, and x86 does not reorder a
+	   store before earlier loads or stores, so a plain increment
+	   after a compiler barrier is enough to hand L on. */
+	old_level = l->old_level;
+	barrier ();
+	l->owner++;
+	intr_set_level (old_level);
+}
+
+/* Returns true if L is held.  Since interrupts are off while a
+   spinlock is held, this is only meaningful as an assertion by the
+   holder. */
+bool
+spinlock_held (const struct spinlock *l) {
+	ASSERT (l != NULL);
+
+	return l->owner != l->next;
+}
+
+/* Initializes seqlock S. */
+void
+seqlock_init (struct seqlock *s) {
+	ASSERT (s != NULL);
+
+	s->seq = 0;
+}
+
+/* Begins a change to the data S protects.  Interrupts must be
+   off, and the caller must already exclude other writers. */
+void
+seqlock_write_begin (struct seqlock *s) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (s->seq % 2 == 0);
+
+	/* x86 does not reorder stores with other stores, so a compiler
+	   barrier keeps the odd number ahead of the data. */
+	s->seq++;
+	barrier ();
+}
+
+/* Ends a change begun by seqlock_write_begin(). */
+void
+seqlock_write_end (struct seqlock *s) {
+	ASSERT (s->seq % 2 != 0);
+
+	barrier ();
+	s->seq++;
+}
+
+/* Begins reading the data S protects, waiting for any change in
+   progress on another CPU to finish, and returns the number to
+   pass to seqlock_read_retry(). */
+uint32_t
+seqlock_read_begin (const struct seqlock *s) {
+	uint32_t seq;
+
+	while ((seq = s->seq) % 2 != 0)
+		cpu_relax ();
+	/* Nor does it reorder loads with other loads. */
+	barrier ();
+	return seq;
+}
+
+/* Returns true if the data S protects may have changed since the
+   seqlock_read_begin() that returned SEQ, in which case whatever
+   was read since must be discarded and read again. */
+bool
+seqlock_read_retry (const struct seqlock *s, uint32_t seq) {
+	barrier ();
+	return s->seq != seq;
+}
+
+/* Initializes readers-writer lock RW as unheld. */
+void
+rwlock_init (struct rwlock *rw) {
+	ASSERT (rw != NULL);
+
+	lock_init (&rw->lock);
+	rw->readers = 0;
+	rw->writer_waiting = false;
+	sema_init (&rw->drained, 0);
+	list_init (&rw->readers_held);
+}
+
+/* Keeps statistics for RW under NAME, as lock_set_name() does.
+   They count writers, and readers only while they wait to get
+   in, since readers do not hold RW's lock while they read. */
+void
+rwlock_set_name (struct rwlock *rw, const char *name) {
+	lock_set_name (&rw->lock, name);
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or is
+   waiting for it.  The same thread may hold RW for reading more
+   than once, but not if a writer might come between.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_read_acquire (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	lock_acquire (&rw->lock);
+	old_level = intr_disable ();
+	rw->readers++;
+	if (!thread_mlfqs)
+		donation_read_acquire (rw);
+	intr_set_level (old_level);
+	lock_release (&rw->lock);
+}
+
+/* Acquires RW for reading like rwlock_read_acquire(), but waits
+   for at most TICKS timer ticks.  Returns true if RW was acquired,
+   false if the time ran out first. */
+bool
+rwlock_read_acquire_timeout (struct rwlock *rw, int64_t ticks) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	if (!lock_acquire_timeout (&rw->lock, ticks))
+		return false;
+	old_level = intr_disable ();
+	rw->readers++;
+	if (!thread_mlfqs)
+		donation_read_acquire (rw);
+	intr_set_level (old_level);
+	lock_release (&rw->lock);
+	return true;
+}
+
+/* Releases RW, which the current thread holds for reading.  Lets
+   a waiting writer in if we were the last reader, and yields if a
+   writer's donation kept us ahead of a thread that is ready.
+   Never sleeps. */
+void
+rwlock_read_release (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+
+	old_level = intr_disable ();
+	ASSERT (rw->readers > 0);
+	if (!thread_mlfqs)
+		donation_read_release (rw);
+	if (--rw->readers == 0 && rw->writer_waiting) {
+		rw->writer_waiting = false;
+		sema_up (&rw->drained);
+	}
+	intr_set_level (old_level);
+	if (!thread_mlfqs)
+		test_max_priority ();
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it.  From the time we get RW's lock, no new reader gets in.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_write_acquire (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	lock_acquire (&rw->lock);
+	old_level = intr_disable ();
+	if (rw->readers > 0) {
+		rw->writer_waiting = true;
+		if (!thread_mlfqs)
+			donation_readers_wait (rw);
+		sema_down (&rw->drained);
+		if (!thread_mlfqs)
+			donation_readers_done (rw);
+	}
+	intr_set_level (old_level);
+}
+
+/* Acquires RW for writing like rwlock_write_acquire(), but waits
+   for at most TICKS timer ticks in all.  Returns true if RW was
+   acquired, false if the time ran out first, whether waiting for
+   another writer or for readers to leave. */
+bool
+rwlock_write_acquire_timeout (struct rwlock *rw, int64_t ticks) {
+	int64_t deadline = timer_ticks () + ticks;
+	enum intr_level old_level;
+	bool success = true;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	if (!lock_acquire_timeout (&rw->lock, ticks))
+		return false;
+	old_level = intr_disable ();
+	if (rw->readers > 0) {
+		rw->writer_waiting = true;
+		if (!thread_mlfqs)
+			donation_readers_wait (rw);
+		/* Interrupts stay off, so no reader can leave between the
+		   time running out and our giving up. */
+		if (!sema_down_timeout (&rw->drained, deadline - timer_ticks ())) {
+			rw->writer_waiting = false;
+			success = false;
+		}
+		if (!thread_mlfqs)
+			donation_readers_done (rw);
+	}
+	intr_set_level (old_level);
+	if (!success)
+		lock_release (&rw->lock);
+	return success;
+}
+
+/* Releases RW, which the current thread holds for writing. */
+void
+rwlock_write_release (struct rwlock *rw) {
+	ASSERT (rwlock_write_held (rw));
+
+	lock_release (&rw->lock);
+}
+
+/* Returns true if the current thread holds RW for writing. */
+bool
+rwlock_write_held (const struct rwlock *rw) {
+	ASSERT (rw != NULL);
+
+	return lock_held_by_current_thread (&rw->lock) && rw->readers == 0;
+}
+
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -292,7 +832,7 @@ void
 cond_init (struct condition *cond) {
 	ASSERT (cond != NULL);
 
-	list_init (&cond->waiters);
+	rbtree_init (&cond->waiters, cond_waiter_less, NULL);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -318,21 +858,73 @@ cond_init (struct condition *cond) {
 void
 cond_wait (struct condition *cond, struct lock *lock) {
 	struct semaphore_elem waiter;
-	
-  ASSERT (cond != NULL);
+	enum intr_level old_level;
+
+	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
 	sema_init (&waiter.semaphore, 0);
+	waiter.cond = cond;
+	waiter.thread = thread_current ();
 
-  list_insert_ordered(&cond->waiters, &waiter.elem, cmp_sem_priority, NULL);
-  
-  lock_release (lock);
+	/* Donation may move us in COND's waiters at any time, from a
+	   thread that does not hold LOCK, so they are changed only
+	   with interrupts off. */
+	old_level = intr_disable ();
+	rbtree_insert (&cond->waiters, &waiter.elem);
+	waiter.thread->cond_waiter = &waiter;
+	intr_set_level (old_level);
+
+	lock_release (lock);
 	sema_down (&waiter.semaphore);
 	lock_acquire (lock);
 }
 
+/* Like cond_wait(), but waits for COND to be signaled for at
+   most TICKS timer ticks.  Returns true if it was signaled, false
+   if the time ran out first.  Either way, LOCK is held again on
+   return. */
+bool
+cond_wait_timeout (struct condition *cond, struct lock *lock,
+		int64_t ticks) {
+	struct semaphore_elem waiter;
+	enum intr_level old_level;
+	bool signaled;
+
+	ASSERT (cond != NULL);
+	ASSERT (lock != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (lock_held_by_current_thread (lock));
+
+	sema_init (&waiter.semaphore, 0);
+	waiter.cond = cond;
+	waiter.thread = thread_current ();
+
+	old_level = intr_disable ();
+	rbtree_insert (&cond->waiters, &waiter.elem);
+	waiter.thread->cond_waiter = &waiter;
+	intr_set_level (old_level);
+
+	lock_release (lock);
+	signaled = sema_down_timeout (&waiter.semaphore, ticks);
+	if (!signaled) {
+		/* Leave COND's waiters, unless a signal picked us after
+		   the time ran out, in which case we take it rather than
+		   lose it. */
+		old_level = intr_disable ();
+		if (waiter.thread->cond_waiter == &waiter) {
+			rbtree_remove (&cond->waiters, &waiter.elem);
+			waiter.thread->cond_waiter = NULL;
+		} else
+			signaled = true;
+		intr_set_level (old_level);
+	}
+	lock_acquire (lock);
+	return signaled;
+}
+
 /* If any threads are waiting on COND (protected by LOCK), then
    this function signals one of them to wake up from its wait.
    LOCK must be held before calling this function.
@@ -342,17 +934,25 @@ cond_wait (struct condition *cond, struct lock *lock) {
    interrupt handler. */
 void
 cond_signal (struct condition *cond, struct lock *lock UNUSED) {
+	struct semaphore_elem *waiter = NULL;
+	enum intr_level old_level;
+
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
-	if (!list_empty (&cond->waiters)) {
-    list_sort(&cond->waiters, cmp_sem_priority, NULL);
-   
-		sema_up (&list_entry (list_pop_front (&cond->waiters), struct semaphore_elem, elem)->semaphore);
-  }
+	old_level = intr_disable ();
+	if (!rbtree_empty (&cond->waiters)) {
+		waiter = rbtree_entry (rbtree_min (&cond->waiters),
+				struct semaphore_elem, elem);
+		rbtree_remove (&cond->waiters, &waiter->elem);
+		waiter->thread->cond_waiter = NULL;
+	}
+	intr_set_level (old_level);
 
+	if (waiter != NULL)
+		sema_up (&waiter->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -366,6 +966,6 @@ cond_broadcast (struct condition *cond, struct lock *lock) {
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 
-	while (!list_empty (&cond->waiters))
+	while (!rbtree_empty (&cond->waiters))
 		cond_signal (cond, lock);
 }
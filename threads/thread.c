@@ -3,14 +3,20 @@
 #include <debug.h>
 #include <stddef.h>
 #include <random.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/flags.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/kstack.h"
+#include "threads/objcache.h"
 #include "threads/palloc.h"
+#include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #include "intrinsic.h"
 // * 추가
 #include "threads/malloc.h"
@@ -28,64 +34,229 @@
    Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Per-CPU scheduler state.
+
+   Each CPU schedules from its own run queue, so the common paths
+   never touch another CPU's data.  Only the bootstrap processor
+   runs so far; the run queue locks keep the queues safe once
+   other CPUs start, and moving work between the queues is left
+   until then.  The running thread is still found from the stack pointer, which is
+   naturally per-CPU because each CPU runs on the kernel stack of
+   its own thread. */
+struct cpu {
+	unsigned id;                    /* Index in cpus[]. */
+	struct thread *idle_thread;     /* Runs when the run queue is empty. */
+	struct thread *running;         /* Thread currently running here. */
+
+	/* Run queue, protected by rq_lock.
+
+	   ready_list is only used when thread_ready_list is true.
+	   Otherwise each priority level has its own FIFO, and bit P of
+	   ready_mask is set exactly when ready_queues[P] is nonempty,
+	   so the highest-priority ready thread is found with a single
+	   bit scan instead of an ordered insert into ready_list. */
+	struct spinlock rq_lock;
+	struct list ready_list;
+	struct list ready_queues[PRI_MAX + 1];
+	uint64_t ready_mask;
+	size_t ready_cnt;               /* # of threads in the run queue. */
+
+	/* Run queue of the fair-share scheduler, also protected by
+	   rq_lock: ready threads ordered by vruntime. */
+	struct rbtree fair_tree;
+	unsigned long fair_weight;      /* Sum of weights in fair_tree. */
+	int64_t min_vruntime;           /* Never decreases. */
+
+	/* Run queue of the EDF real-time class, also protected by
+	   rq_lock: ready real-time threads ordered by deadline.  They
+	   are counted in ready_cnt as well as in edf_cnt, and are
+	   picked ahead of every thread in the queues above. */
+	struct rbtree edf_tree;
+	size_t edf_cnt;                 /* # of threads in edf_tree. */
+
+	/* Threads that died here, freed by the next do_schedule(). */
+	struct list destruction_req;
+
+	/* Scheduling. */
+	unsigned thread_ticks;          /* # of timer ticks since last yield. */
+
+	/* Statistics. */
+	long long idle_ticks;           /* # of timer ticks spent idle. */
+	long long kernel_ticks;         /* # of timer ticks in kernel threads. */
+	long long user_ticks;           /* # of timer ticks in user programs. */
+	struct sched_stats sched;       /* Totals over the threads run here. */
+	struct seqlock sched_seq;       /* Guards `sched'. */
+};
+
+#if PRI_MAX - PRI_MIN + 1 > 64
+#error ready_mask needs one bit per priority level
+#endif
 
-static struct list sleep_list;
-static int64_t next_tick_to_awake = INT64_MAX;
+/* CPUs.  Only the bootstrap processor, cpus[0], is started so far,
+   so cpu_cnt is 1 and this_cpu() needs no lookup. */
+#define NCPU_MAX 8
+static struct cpu cpus[NCPU_MAX];
+static unsigned cpu_cnt = 1;
 
-/* Idle thread. */
-static struct thread *idle_thread;
+/* Threads blocked in thread_sleep(), keyed by wake up tick.
+   Shared by all CPUs and protected by sleep_lock. */
+static struct wheel sleep_wheel;
+static struct spinlock sleep_lock;
+static int64_t next_tick_to_awake = INT64_MAX;
 
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
-/* Lock used by allocate_tid(). */
-static struct lock tid_lock;
+/* Every thread that has not yet exited, keyed by tid, for
+   thread_lookup_child().  Protected by tid_table_lock.  The table's
+   buckets are allocated with malloc(), so it is only set up by
+   thread_start(). */
+static struct hash tid_table;
+static struct lock tid_table_lock;
 
-/* Thread destruction requests */
-static struct list destruction_req;
-
-/* Statistics. */
-static long long idle_ticks;    /* # of timer ticks spent idle. */
-static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
-static long long user_ticks;    /* # of timer ticks in user programs. */
+/* File descriptor tables, one page each.  A table is freed only
+   after all its files have been closed, so the entries of a cached
+   table from fd 2 up are null pointers again and it can be reused
+   without clearing.  thread_create() sets fds 0 and 1. */
+#define FDT_CACHE_MAX 16
+static struct objcache fdt_cache;
 
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
-static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
 // * Advanced Scheuler 추가
-#define NICE_DEFAULT 0
 #define RECENT_CPU_DEFAULT 0
 #define LOAD_AVG_DEFAULT 0 
 
 int load_avg;
 
+/* Lazy recent_cpu decay.  Once per second every thread's
+   recent_cpu is decayed by the same coefficient, which depends only
+   on load_avg at that moment.  Instead of visiting every thread,
+   mlfqs_recalc() records the coefficient under a new decay epoch
+   and a thread's recent_cpu is caught up, one recorded epoch at a
+   time, when it is next touched.  Only threads that can be
+   scheduled, the running and ready ones, need an up-to-date
+   priority, so only they are visited each second; blocked threads
+   catch up when they are unblocked.
+
+   Only the last DECAY_HISTORY coefficients are kept, so before the
+   oldest one is overwritten every thread in blocked_list is caught
+   up.  No decay is ever skipped: a thread blocked for a long time
+   still sees every coefficient, in order, just at most
+   DECAY_HISTORY of them at once. */
+#define DECAY_HISTORY 64
+static int decay_coef[DECAY_HISTORY];   /* Coefficient, by epoch. */
+static int64_t decay_epoch;             /* # of decays so far. */
+
+/* Threads blocked with -mlfqs, which may fall behind decay_epoch.
+   Protected by blocked_lock. */
+static struct list blocked_list;
+static struct spinlock blocked_lock;
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* If true, use the fair-share scheduler: each thread receives a
+   share of the CPU proportional to a weight derived from its nice
+   value, and priorities do not affect scheduling.
+   Controlled by kernel command-line option "-fair". */
+bool thread_fair;
+
+/* Fair-share scheduler.
+
+   Each thread accumulates virtual runtime, its CPU time scaled
+   inversely to its weight, and the ready thread with the least
+   virtual runtime runs next.  Weights are indexed by nice value;
+   each step in nice is about a 1.25x step in CPU share.  Virtual
+   runtime is kept in units of 1/FAIR_WEIGHT_0 tick of a nice-0
+   thread.
+
+   Rather than a fixed TIME_SLICE, each ready thread should run once
+   every FAIR_LATENCY ticks, for a slice proportional to its share
+   of the total weight, but no shorter than FAIR_MIN_SLICE. */
+#define FAIR_WEIGHT_0 1024      /* Weight of a nice-0 thread. */
+#define FAIR_LATENCY 20         /* Target scheduling period, in ticks. */
+#define FAIR_MIN_SLICE 1        /* Minimum time slice, in ticks. */
+#define FAIR_WAKEUP_GRAN FAIR_WEIGHT_0  /* Lead needed to preempt. */
+
+static const int fair_weights[NICE_MAX - NICE_MIN + 1] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */  9548,  7620,  6100,  4904,  3906,
+	/*  -5 */  3121,  2501,  1991,  1586,  1277,
+	/*   0 */  1024,   820,   655,   526,   423,
+	/*   5 */   335,   272,   215,   172,   137,
+	/*  10 */   110,    87,    70,    56,    45,
+	/*  15 */    36,    29,    23,    18,    15,
+	/*  20 */    12,
+};
+
+/* If false (default), use the per-priority ready queues.
+   If true, use the single ready_list ordered by cmp_priority.
+   Controlled by kernel command-line option "-ready-list". */
+bool thread_ready_list;
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
 static struct thread *next_thread_to_run (void);
-static void init_thread (struct thread *, const char *name, int priority, int wakeup_tick);
+static void init_thread (struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule (void);
+static void sched_account (struct cpu *, struct thread *prev,
+		struct thread *next);
+static void sched_record_wakeup (struct sched_stats *, int64_t latency);
+static void sched_write_begin (struct cpu *, struct thread *);
+static void sched_write_end (struct cpu *, struct thread *);
+static void sched_stats_copy (const struct seqlock *,
+		const struct sched_stats *, struct sched_stats *);
 static tid_t allocate_tid (void);
+static uint64_t tid_hash (const struct hash_elem *, void *aux);
+static bool tid_less (const struct hash_elem *, const struct hash_elem *,
+		void *aux);
+static void tid_table_insert (struct thread *);
+static void *fdt_create (void);
+static void fdt_destroy (void *);
+static struct cpu *this_cpu (void);
+static void cpu_init (struct cpu *, unsigned id);
+static bool is_idle_thread (const struct thread *);
+static void rq_insert (struct cpu *, struct thread *);
+static void rq_remove (struct cpu *, struct thread *);
+static void ready_push (struct thread *);
+static struct thread *ready_pop (struct cpu *);
+static int ready_max_priority (void);
+static void set_priority (struct thread *, int priority);
+static int mlfqs_calc_priority (const struct thread *);
+static bool fair_less (const struct rbtree_elem *,
+		const struct rbtree_elem *, void *aux);
+static int fair_weight (const struct thread *);
+static void fair_update_min (struct cpu *);
+static unsigned fair_slice (struct cpu *, const struct thread *);
+static bool fair_should_preempt (void);
+static bool is_edf (const struct thread *);
+static bool edf_less (const struct rbtree_elem *,
+		const struct rbtree_elem *, void *aux);
+static int64_t edf_utilization (int64_t runtime, int64_t deadline);
+static void edf_replenish (struct thread *, int64_t now);
+static void edf_wakeup (struct thread *, int64_t now);
+static void edf_sleep (struct thread *);
+static bool edf_should_preempt (void);
+static void sleep_until (struct thread *, int64_t ticks);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
 
 /* Returns the running thread.
  * Read the CPU's stack pointer `rsp', and then round that
- * down to the start of a page.  Since `struct thread' is
- * always at the beginning of a page and the stack pointer is
- * somewhere in the middle, this locates the curent thread. */
-#define running_thread() ((struct thread *) (pg_round_down (rrsp ())))
+ * down to a multiple of KSTACK_SIZE.  Since `struct thread' is
+ * always at the beginning of a kernel stack region and the stack
+ * pointer is somewhere in the middle, this locates the curent
+ * thread.  The initial thread's page is suitably aligned too. */
+#define running_thread() \
+	((struct thread *) (rrsp () & ~(uint64_t) (KSTACK_SIZE - 1)))
 
 
 // Global descriptor table for the thread_start.
@@ -120,16 +291,56 @@ thread_init (void) {
 	lgdt (&gdt_ds);
 
 	/* Init the globla thread context */
-	lock_init (&tid_lock);
-	list_init (&ready_list);
-	list_init (&sleep_list);
-	list_init (&destruction_req);
+	lock_init (&tid_table_lock);
+	lock_set_name (&tid_table_lock, "tid_table");
+	kstack_init ();
+	objcache_init (&fdt_cache, "File table", FDT_CACHE_MAX,
+			fdt_create, fdt_destroy);
+	for (unsigned id = 0; id < NCPU_MAX; id++)
+		cpu_init (&cpus[id], id);
+	wheel_init (&sleep_wheel, 0);
+	spinlock_init (&sleep_lock);
+	list_init (&blocked_list);
+	spinlock_init (&blocked_lock);
 
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread ();
-	init_thread (initial_thread, "main", PRI_DEFAULT, 0);
+	init_thread (initial_thread, "main", PRI_DEFAULT);
 	initial_thread->status = THREAD_RUNNING;
 	initial_thread->tid = allocate_tid ();
+	this_cpu ()->running = initial_thread;
+}
+
+/* Initializes C as the CPU with index ID, with an empty run
+   queue. */
+static void
+cpu_init (struct cpu *c, unsigned id) {
+	memset (c, 0, sizeof *c);
+	c->id = id;
+	spinlock_init (&c->rq_lock);
+	seqlock_init (&c->sched_seq);
+	list_init (&c->ready_list);
+	for (int i = PRI_MIN; i <= PRI_MAX; i++)
+		list_init (&c->ready_queues[i]);
+	rbtree_init (&c->fair_tree, fair_less, NULL);
+	rbtree_init (&c->edf_tree, edf_less, NULL);
+	list_init (&c->destruction_req);
+}
+
+/* Returns the CPU we are running on. */
+static struct cpu *
+this_cpu (void) {
+	ASSERT (cpu_cnt == 1);
+	return &cpus[0];
+}
+
+/* Returns true if T is the idle thread of some CPU. */
+static bool
+is_idle_thread (const struct thread *t) {
+	for (unsigned id = 0; id < cpu_cnt; id++)
+		if (cpus[id].idle_thread == t)
+			return true;
+	return false;
 }
 
 /* Starts preemptive thread scheduling by enabling interrupts.
@@ -138,6 +349,11 @@ void
 thread_start (void) {
 	/* Create the idle thread. */
 	struct semaphore idle_started;
+
+	if (!hash_init (&tid_table, tid_hash, tid_less, NULL))
+		PANIC ("out of memory for the thread table");
+	tid_table_insert (initial_thread);
+
 	sema_init (&idle_started, 0);
 	thread_create ("idle", PRI_MIN, idle, &idle_started);
   load_avg = LOAD_AVG_DEFAULT;
@@ -153,28 +369,140 @@ thread_start (void) {
    Thus, this function runs in an external interrupt context. */
 void
 thread_tick (void) {
+	struct cpu *c = this_cpu ();
 	struct thread *t = thread_current ();
 
 	/* Update statistics. */
-	if (t == idle_thread)
-		idle_ticks++;
+	if (t == c->idle_thread)
+		c->idle_ticks++;
 #ifdef USERPROG
 	else if (t->pml4 != NULL)
-		user_ticks++;
+		c->user_ticks++;
 #endif
 	else
-		kernel_ticks++;
+		c->kernel_ticks++;
+	if (t != c->idle_thread) {
+		sched_write_begin (c, t);
+		t->sched.run_ticks++;
+		c->sched.run_ticks++;
+		sched_write_end (c, t);
+	}
+
+	/* Charge the tick to T's virtual runtime. */
+	if (thread_fair && t != c->idle_thread && !is_edf (t)) {
+		t->vruntime += (int64_t) FAIR_WEIGHT_0 * FAIR_WEIGHT_0 / fair_weight (t);
+		fair_update_min (c);
+	}
 
-	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	/* Enforce preemption.  A real-time thread has no time slice,
+	   but is throttled once it uses up its runtime. */
+	if (is_edf (t)) {
+		if (--t->edf_budget <= 0) {
+			t->edf_throttled = true;
+			sched_write_begin (c, t);
+			t->sched.edf_throttles++;
+			c->sched.edf_throttles++;
+			sched_write_end (c, t);
+			intr_yield_on_return ();
+		}
+	} else if (++c->thread_ticks >= (thread_fair ? fair_slice (c, t) : TIME_SLICE)
+			|| (t == c->idle_thread && c->ready_cnt > 0))
 		intr_yield_on_return ();
 }
 
+/* Accounts for CNT timer ticks that passed without a timer
+   interrupt while the idle thread was running (see
+   timer_idle_enter()).  Runs with interrupts off. */
+void
+thread_tick_idle (int64_t cnt) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	this_cpu ()->idle_ticks += cnt;
+}
+
 /* Prints thread statistics. */
 void
 thread_print_stats (void) {
+	long long idle_ticks = 0, kernel_ticks = 0, user_ticks = 0;
+	struct sched_stats s;
+
+	for (unsigned id = 0; id < cpu_cnt; id++) {
+		idle_ticks += cpus[id].idle_ticks;
+		kernel_ticks += cpus[id].kernel_ticks;
+		user_ticks += cpus[id].user_ticks;
+	}
 	printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 			idle_ticks, kernel_ticks, user_ticks);
+	if (cpu_cnt > 1)
+		for (unsigned id = 0; id < cpu_cnt; id++)
+			printf ("CPU %u: %lld idle ticks, %lld kernel ticks, "
+					"%lld user ticks\n", id, cpus[id].idle_ticks,
+					cpus[id].kernel_ticks, cpus[id].user_ticks);
+	thread_sched_stats (NULL, &s);
+	printf ("Scheduler: %lld voluntary switches, %lld involuntary switches, "
+			"%lld ticks waiting\n", s.nvcsw, s.nivcsw, s.wait_ticks);
+	if (s.wakeup_cnt > 0) {
+		int last = SCHED_LAT_BUCKETS - 1;
+		while (s.lat_hist[last] == 0)
+			last--;
+		printf ("Wakeup latency: %lld wakeups, max %lld ticks;",
+				s.wakeup_cnt, s.lat_max);
+		for (int i = 0; i <= last; i++)
+			if (i == 0)
+				printf (" 0: %lld", s.lat_hist[i]);
+			else if (i == SCHED_LAT_BUCKETS - 1)
+				printf (", %lld+: %lld", 1LL << (i - 1), s.lat_hist[i]);
+			else
+				printf (", %lld-%lld: %lld", 1LL << (i - 1), (1LL << i) - 1,
+						s.lat_hist[i]);
+		printf ("\n");
+	}
+	if (s.edf_jobs > 0 || s.edf_throttles > 0)
+		printf ("EDF: %lld jobs, %lld deadline misses, %lld throttles\n",
+				s.edf_jobs, s.edf_misses, s.edf_throttles);
+	kstack_print_stats ();
+	fpu_print_stats ();
+	objcache_print_stats (&fdt_cache);
+}
+
+/* Returns the most bytes of kernel stack the running thread has
+   used so far.  Not tracked for the initial thread, whose stack
+   was set up by the loader. */
+size_t
+thread_stack_used (void) {
+	struct thread *t = thread_current ();
+
+	return t != initial_thread ? kstack_used (t) : 0;
+}
+
+/* Copies T's scheduling statistics into *S, or, if T is a null
+   pointer, the totals over all threads.  T must not exit
+   meanwhile.  Never turns interrupts off, so it may be called as
+   often as desired. */
+void
+thread_sched_stats (struct thread *t, struct sched_stats *s) {
+	if (t != NULL)
+		sched_stats_copy (&t->sched_seq, &t->sched, s);
+	else {
+		memset (s, 0, sizeof *s);
+		for (unsigned id = 0; id < cpu_cnt; id++) {
+			struct sched_stats copy;
+			const struct sched_stats *cs = &copy;
+
+			sched_stats_copy (&cpus[id].sched_seq, &cpus[id].sched, &copy);
+			s->run_ticks += cs->run_ticks;
+			s->wait_ticks += cs->wait_ticks;
+			s->nvcsw += cs->nvcsw;
+			s->nivcsw += cs->nivcsw;
+			s->wakeup_cnt += cs->wakeup_cnt;
+			if (cs->lat_max > s->lat_max)
+				s->lat_max = cs->lat_max;
+			for (int i = 0; i < SCHED_LAT_BUCKETS; i++)
+				s->lat_hist[i] += cs->lat_hist[i];
+			s->edf_jobs += cs->edf_jobs;
+			s->edf_misses += cs->edf_misses;
+			s->edf_throttles += cs->edf_throttles;
+		}
+	}
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -195,30 +523,33 @@ thread_print_stats (void) {
 tid_t
 thread_create (const char *name, int priority,
 		thread_func *function, void *aux) {
+	struct switch_threads_frame *sf;
 	struct thread *t;
 	tid_t tid;
 
 	ASSERT (function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page (PAL_ZERO);
+	t = kstack_alloc ();
 	if (t == NULL)
 		return TID_ERROR;
 
 	/* Initialize thread. */
-	init_thread (t, name, priority, 0);
+	init_thread (t, name, priority);
 	tid = t->tid = allocate_tid ();
-
-	/* Call the kernel_thread if it scheduled.
-	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
-	t->tf.rip = (uintptr_t) kernel_thread;
-	t->tf.R.rdi = (uint64_t) function;
-	t->tf.R.rsi = (uint64_t) aux;
-	t->tf.ds = SEL_KDSEG;
-	t->tf.es = SEL_KDSEG;
-	t->tf.ss = SEL_KDSEG;
-	t->tf.cs = SEL_KCSEG;
-	t->tf.eflags = FLAG_IF;
+	t->vruntime = this_cpu ()->min_vruntime;
+	fpu_init_thread (t);
+
+	/* Build a frame at the top of the stack for switch_threads()
+	 * to "return" into switch_entry(), which then calls
+	 * kernel_thread (FUNCTION, AUX). */
+	sf = (struct switch_threads_frame *) ((uint8_t *) t + KSTACK_SIZE) - 1;
+	memset (sf, 0, sizeof *sf);
+	sf->rbx = (uint64_t) kernel_thread;
+	sf->r12 = (uint64_t) function;
+	sf->r13 = (uint64_t) aux;
+	sf->rip = switch_entry;
+	t->ksp = (uint64_t) sf;
 
   // * USERPROG 추가
   t->parent = thread_current(); // * 부모 프로세스 저장
@@ -230,7 +561,7 @@ thread_create (const char *name, int priority,
 
   // * 파일 디스크립터 초기값 설정
   // t->fdt = (struct file **)calloc(128, sizeof(struct file *));
-  t->fdt = palloc_get_page(PAL_ZERO);
+  t->fdt = fdt_alloc ();
 	if (t->fdt == NULL) {
 		return TID_ERROR;
 	}
@@ -238,6 +569,8 @@ thread_create (const char *name, int priority,
   t->fdt[1] = 2;
   t->next_fd = 2;
 
+	tid_table_insert (t);
+
 	/* Add to run queue. */
 	thread_unblock (t);
   // * 추가 코드
@@ -258,15 +591,420 @@ cmp_priority (const struct list_elem *a, const struct list_elem *b, void *aux UN
 }
 
 // * test_max_priority() 함수 추가
+/* Yields if a ready thread should run instead of the current one.
+   In an interrupt handler, the yield happens on the way out.  Only
+   a real-time thread with an earlier deadline can preempt a
+   real-time thread. */
 void test_max_priority (void) {
+	bool preempt;
 
-  // * 추가 코드
-  if (!list_empty(&ready_list)) {
-    if (cmp_priority(list_begin(&ready_list), &thread_current()->elem, NULL)) {
-      thread_yield();
-    }
-  }
+	if (edf_should_preempt ())
+		preempt = true;
+	else if (is_edf (thread_current ()))
+		preempt = false;
+	else
+		preempt = thread_fair ? fair_should_preempt ()
+			: ready_max_priority () > thread_current ()->priority;
+	if (preempt) {
+		if (intr_context ())
+			intr_yield_on_return ();
+		else
+			thread_yield ();
+	}
+}
+
+/* Appends T to C's ready queue for its priority. */
+static void
+rq_insert (struct cpu *c, struct thread *t) {
+	ASSERT (spinlock_held (&c->rq_lock));
+
+	list_push_back (&c->ready_queues[t->priority], &t->elem);
+	c->ready_mask |= 1ULL << t->priority;
+}
+
+/* Removes T from C's ready queue for its priority. */
+static void
+rq_remove (struct cpu *c, struct thread *t) {
+	ASSERT (spinlock_held (&c->rq_lock));
+
+	list_remove (&t->elem);
+	if (list_empty (&c->ready_queues[t->priority]))
+		c->ready_mask &= ~(1ULL << t->priority);
+}
+
+/* Adds T to the current CPU's run queue. */
+static void
+ready_push (struct thread *t) {
+	struct cpu *c = this_cpu ();
+
+	spinlock_acquire (&c->rq_lock);
+	if (is_edf (t)) {
+		rbtree_insert (&c->edf_tree, &t->edf_elem);
+		c->edf_cnt++;
+	} else if (thread_fair) {
+		rbtree_insert (&c->fair_tree, &t->fair_elem);
+		c->fair_weight += fair_weight (t);
+	} else if (thread_ready_list)
+		list_insert_ordered (&c->ready_list, &t->elem, cmp_priority, NULL);
+	else
+		rq_insert (c, t);
+	c->ready_cnt++;
+	t->cpu = c;
+	spinlock_release (&c->rq_lock);
+}
+
+/* Removes and returns the highest-priority thread in C's run
+   queue, or a null pointer if the run queue is empty.  Threads of
+   equal priority are returned in FIFO order.  Real-time threads
+   come first, earliest deadline first. */
+static struct thread *
+ready_pop (struct cpu *c) {
+	struct thread *t = NULL;
+
+	spinlock_acquire (&c->rq_lock);
+	if (c->ready_cnt > 0) {
+		c->ready_cnt--;
+		if (c->edf_cnt > 0) {
+			t = rbtree_entry (rbtree_min (&c->edf_tree), struct thread, edf_elem);
+			rbtree_remove (&c->edf_tree, &t->edf_elem);
+			c->edf_cnt--;
+		} else if (thread_fair) {
+			t = rbtree_entry (rbtree_min (&c->fair_tree), struct thread, fair_elem);
+			rbtree_remove (&c->fair_tree, &t->fair_elem);
+			c->fair_weight -= fair_weight (t);
+		} else if (thread_ready_list)
+			t = list_entry (list_pop_front (&c->ready_list), struct thread, elem);
+		else {
+			t = list_entry (list_front (&c->ready_queues[bsrq (c->ready_mask)]),
+					struct thread, elem);
+			rq_remove (c, t);
+		}
+	}
+	spinlock_release (&c->rq_lock);
+	return t;
+}
+
+/* Returns the priority of the best thread other than a real-time
+   thread in the current CPU's run queue, or -1 if there is none. */
+static int
+ready_max_priority (void) {
+	struct cpu *c = this_cpu ();
+	int priority = -1;
+
+	spinlock_acquire (&c->rq_lock);
+	if (c->ready_cnt > c->edf_cnt) {
+		if (thread_fair)
+			priority = rbtree_entry (rbtree_min (&c->fair_tree),
+					struct thread, fair_elem)->priority;
+		else if (thread_ready_list)
+			priority = list_entry (list_begin (&c->ready_list),
+					struct thread, elem)->priority;
+		else
+			priority = bsrq (c->ready_mask);
+	}
+	spinlock_release (&c->rq_lock);
+	return priority;
+}
+
+/* Sets T's effective priority to PRIORITY.  If T is in a run
+   queue, it is moved to the queue for its new priority, at the
+   back, as if it had just become ready.  The ordered ready_list
+   keeps its old behavior of not being re-sorted, and the
+   fair-share scheduler and the EDF class ignore priorities.  If
+   T is waiting for a semaphore or condition variable, it is moved
+   to its new place among the waiters.  Interrupts must be off. */
+static void
+set_priority (struct thread *t, int priority) {
+	struct cpu *c = t->cpu;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (t->priority == priority)
+		return;
+
+	synch_unqueue (t);
+	if (c == NULL)
+		t->priority = priority;
+	else {
+		spinlock_acquire (&c->rq_lock);
+		if (t->status == THREAD_READY && !thread_ready_list && !thread_fair
+				&& !is_edf (t)) {
+			rq_remove (c, t);
+			t->priority = priority;
+			rq_insert (c, t);
+		} else
+			t->priority = priority;
+		spinlock_release (&c->rq_lock);
+	}
+	synch_requeue (t);
+}
+
+/* Orders threads in a fair_tree by vruntime. */
+static bool
+fair_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = rbtree_entry (a_, struct thread, fair_elem);
+	const struct thread *b = rbtree_entry (b_, struct thread, fair_elem);
+
+	return a->vruntime < b->vruntime;
+}
 
+/* Returns T's weight for the fair-share scheduler. */
+static int
+fair_weight (const struct thread *t) {
+	int nice = t->nice;
+
+	if (nice < NICE_MIN)
+		nice = NICE_MIN;
+	else if (nice > NICE_MAX)
+		nice = NICE_MAX;
+	return fair_weights[nice - NICE_MIN];
+}
+
+/* Advances C's min_vruntime to the least vruntime among the
+   thread running on C and the threads in its run queue, if that
+   is later.  min_vruntime never goes backward, so it can serve as
+   the baseline for threads that join the run queue. */
+static void
+fair_update_min (struct cpu *c) {
+	int64_t vruntime = INT64_MAX;
+	struct rbtree_elem *e;
+
+	spinlock_acquire (&c->rq_lock);
+	if (c->running != NULL && c->running != c->idle_thread)
+		vruntime = c->running->vruntime;
+	e = rbtree_min (&c->fair_tree);
+	if (e != NULL) {
+		int64_t first = rbtree_entry (e, struct thread, fair_elem)->vruntime;
+		if (first < vruntime)
+			vruntime = first;
+	}
+	if (vruntime != INT64_MAX && vruntime > c->min_vruntime)
+		c->min_vruntime = vruntime;
+	spinlock_release (&c->rq_lock);
+}
+
+/* Returns the time slice, in ticks, for T running on C: T's share
+   of FAIR_LATENCY in proportion to its weight among all runnable
+   threads on C. */
+static unsigned
+fair_slice (struct cpu *c, const struct thread *t) {
+	unsigned long weight = fair_weight (t);
+	unsigned slice = FAIR_LATENCY * weight / (c->fair_weight + weight);
+
+	return slice > FAIR_MIN_SLICE ? slice : FAIR_MIN_SLICE;
+}
+
+/* Returns true if the first thread in the current CPU's fair_tree
+   is far enough behind the running thread that it should take
+   over right away. */
+static bool
+fair_should_preempt (void) {
+	struct cpu *c = this_cpu ();
+	struct thread *cur = thread_current ();
+	struct rbtree_elem *e;
+	bool preempt = false;
+
+	spinlock_acquire (&c->rq_lock);
+	e = rbtree_min (&c->fair_tree);
+	if (e != NULL)
+		preempt = cur == c->idle_thread
+			|| rbtree_entry (e, struct thread, fair_elem)->vruntime
+				+ FAIR_WAKEUP_GRAN < cur->vruntime;
+	spinlock_release (&c->rq_lock);
+	return preempt;
+}
+
+/* EDF real-time class.
+
+   A thread that calls thread_set_deadline() asks for RUNTIME
+   ticks of CPU time in every PERIOD ticks, within DEADLINE ticks
+   of the start of the period.  Such real-time threads have a run
+   queue of their own, edf_tree, ordered by absolute deadline, and
+   always run ahead of every other thread, whichever scheduler is
+   in use for those.
+
+   Admission control keeps the sum of RUNTIME / DEADLINE over all
+   real-time threads at or below EDF_MAX_UTIL of each CPU, which is
+   enough for EDF to meet every deadline and leaves the rest of the
+   CPU to other threads.  The rest is enforced, not just promised:
+   a real-time thread that uses up its runtime is throttled, that
+   is, made to sleep until its next period, whether or not it has
+   finished.  A thread that blocks partway through a period gets
+   a fresh runtime and deadline on wakeup if what it has left
+   would exceed its share before the old deadline, the rule of the
+   constant bandwidth server, so it cannot save up time either.
+
+   A thread ends each job with thread_deadline_yield(), which
+   counts the job as missed if it ends after its deadline.  The
+   state here is protected by disabling interrupts. */
+
+/* Utilization of a whole CPU, and the part real-time threads may
+   have. */
+#define EDF_UTIL_ONE (1 << 20)
+#define EDF_MAX_UTIL (EDF_UTIL_ONE / 20 * 19)
+
+/* Sum of edf_utilization() over all real-time threads. */
+static int64_t edf_util;
+
+/* Returns true if T is a real-time thread. */
+static bool
+is_edf (const struct thread *t) {
+	return t->edf_runtime > 0;
+}
+
+/* Orders threads in an edf_tree by absolute deadline. */
+static bool
+edf_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = rbtree_entry (a_, struct thread, edf_elem);
+	const struct thread *b = rbtree_entry (b_, struct thread, edf_elem);
+
+	return a->edf_abs_deadline < b->edf_abs_deadline;
+}
+
+/* Returns the share of a CPU, out of EDF_UTIL_ONE, that admission
+   control counts for a thread with the given RUNTIME and DEADLINE,
+   rounded up. */
+static int64_t
+edf_utilization (int64_t runtime, int64_t deadline) {
+	if (runtime == 0)
+		return 0;
+	return DIV_ROUND_UP (runtime * EDF_UTIL_ONE, deadline);
+}
+
+/* Starts a new period for T at tick NOW, with its full runtime. */
+static void
+edf_replenish (struct thread *t, int64_t now) {
+	t->edf_budget = t->edf_runtime;
+	t->edf_abs_deadline = now + t->edf_deadline;
+	t->edf_next_period = now + t->edf_period;
+	t->edf_throttled = false;
+}
+
+/* Called by thread_unblock() for real-time thread T at tick NOW.
+   A throttled T has reached its next period.  Otherwise T was
+   blocked partway through a period, and keeps its runtime and
+   deadline only if that does not give it more than its share. */
+static void
+edf_wakeup (struct thread *t, int64_t now) {
+	if (t->edf_throttled
+			|| now >= t->edf_abs_deadline
+			|| t->edf_budget * t->edf_deadline
+				> (t->edf_abs_deadline - now) * t->edf_runtime)
+		edf_replenish (t, now);
+}
+
+/* Switches away from the running thread T, which is throttled,
+   until its next period, or starts that period right away if it
+   is already due.  Interrupts must be off. */
+static void
+edf_sleep (struct thread *t) {
+	int64_t now = timer_ticks ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->edf_throttled);
+
+	if (t->edf_next_period <= now) {
+		edf_replenish (t, now);
+		t->ready_since = now;
+		ready_push (t);
+		do_schedule (THREAD_READY);
+	} else {
+		sleep_until (t, t->edf_next_period);
+		do_schedule (THREAD_BLOCKED);
+	}
+}
+
+/* Returns true if the first thread in the current CPU's edf_tree
+   should take over right away: the running thread is not a
+   real-time thread, or has a later deadline. */
+static bool
+edf_should_preempt (void) {
+	struct cpu *c = this_cpu ();
+	struct thread *cur = thread_current ();
+	struct rbtree_elem *e;
+	bool preempt = false;
+
+	spinlock_acquire (&c->rq_lock);
+	e = rbtree_min (&c->edf_tree);
+	if (e != NULL)
+		preempt = !is_edf (cur)
+			|| rbtree_entry (e, struct thread, edf_elem)->edf_abs_deadline
+				< cur->edf_abs_deadline;
+	spinlock_release (&c->rq_lock);
+	return preempt;
+}
+
+/* Makes the running thread a real-time thread that needs RUNTIME
+   ticks of CPU time in every PERIOD ticks, within DEADLINE ticks
+   of the start of each period.  Its first period begins now.  If
+   RUNTIME is 0, makes it an ordinary thread again.
+
+   Returns false, and changes nothing, if the parameters are not
+   0 < RUNTIME <= DEADLINE <= PERIOD or if admitting the thread
+   would overcommit the CPU. */
+bool
+thread_set_deadline (int64_t runtime, int64_t deadline, int64_t period) {
+	struct thread *t = thread_current ();
+	enum intr_level old_level;
+	int64_t util, old_util;
+
+	ASSERT (!intr_context ());
+
+	if (runtime < 0 || (runtime > 0 && (runtime > deadline || deadline > period)))
+		return false;
+	util = edf_utilization (runtime, deadline);
+
+	old_level = intr_disable ();
+	old_util = edf_utilization (t->edf_runtime, t->edf_deadline);
+	if (edf_util - old_util + util > (int64_t) EDF_MAX_UTIL * cpu_cnt) {
+		intr_set_level (old_level);
+		return false;
+	}
+	edf_util += util - old_util;
+	t->edf_runtime = runtime;
+	t->edf_deadline = deadline;
+	t->edf_period = period;
+	if (runtime > 0) {
+		edf_replenish (t, timer_ticks ());
+		t->edf_job_deadline = t->edf_abs_deadline;
+	} else
+		t->edf_throttled = false;
+	intr_set_level (old_level);
+
+	/* Leaving the class may let anything preempt us. */
+	test_max_priority ();
+	return true;
+}
+
+/* Ends the running real-time thread's current job and sleeps
+   until its next period, when it gets its full runtime again. */
+void
+thread_deadline_yield (void) {
+	struct cpu *c = this_cpu ();
+	struct thread *t = thread_current ();
+	enum intr_level old_level;
+	int64_t now;
+
+	ASSERT (!intr_context ());
+	ASSERT (is_edf (t));
+
+	old_level = intr_disable ();
+	now = timer_ticks ();
+	sched_write_begin (c, t);
+	t->sched.edf_jobs++;
+	c->sched.edf_jobs++;
+	if (now > t->edf_job_deadline) {
+		t->sched.edf_misses++;
+		c->sched.edf_misses++;
+	}
+	sched_write_end (c, t);
+	t->edf_job_deadline = (t->edf_next_period > now ? t->edf_next_period : now)
+		+ t->edf_deadline;
+	t->edf_throttled = true;
+	edf_sleep (t);
+	intr_set_level (old_level);
 }
 
 /* Puts the current thread to sleep.  It will not be scheduled
@@ -299,8 +1037,31 @@ thread_unblock (struct thread *t) {
 
 	old_level = intr_disable ();
 	ASSERT (t->status == THREAD_BLOCKED);
-  // * 추가 코드
-  list_insert_ordered(&ready_list, &t->elem, cmp_priority, NULL);
+	if (t->on_blocked_list) {
+		spinlock_acquire (&blocked_lock);
+		list_remove (&t->blocked_elem);
+		spinlock_release (&blocked_lock);
+		t->on_blocked_list = false;
+	}
+	if (thread_mlfqs && t->decay_epoch != decay_epoch) {
+		/* Catch up on the decays T missed while blocked.  T is in
+		   no run queue yet, so its priority can be set directly. */
+		mlfqs_recent_cpu (t);
+		t->priority = mlfqs_calc_priority (t);
+	}
+	if (thread_fair) {
+		/* A thread that slept keeps its place, but may not bank
+		   more than half a period of credit. */
+		int64_t floor = this_cpu ()->min_vruntime
+			- (int64_t) FAIR_LATENCY * FAIR_WEIGHT_0 / 2;
+		if (t->vruntime < floor)
+			t->vruntime = floor;
+	}
+	if (is_edf (t))
+		edf_wakeup (t, timer_ticks ());
+	t->ready_since = timer_ticks ();
+	t->woken = true;
+	ready_push (t);
 	t->status = THREAD_READY;
 	intr_set_level (old_level);
 }
@@ -329,6 +1090,30 @@ thread_current (void) {
 	return t;
 }
 
+/* Returns the running thread's child whose tid is TID, or a null
+   pointer if there is none or it has exited.  A child cannot exit
+   until its parent has waited for it, so it stays valid after this
+   returns.  Any other thread might exit and be freed at once, so
+   the check that it is our child is made with tid_table_lock held,
+   which keeps it in the table. */
+struct thread *
+thread_lookup_child (tid_t tid) {
+	struct tid_entry key;
+	struct hash_elem *e;
+	struct thread *t = NULL;
+
+	key.tid = tid;
+	lock_acquire (&tid_table_lock);
+	e = hash_find (&tid_table, &key.elem);
+	if (e != NULL) {
+		t = hash_entry (e, struct thread, tid_entry.elem);
+		if (t->parent != thread_current ())
+			t = NULL;
+	}
+	lock_release (&tid_table_lock);
+	return t;
+}
+
 /* Returns the running thread's tid. */
 tid_t
 thread_tid (void) {
@@ -345,15 +1130,23 @@ thread_exit (void) {
 	process_exit ();
 #endif
 
+	lock_acquire (&tid_table_lock);
+	hash_delete (&tid_table, &thread_current ()->tid_entry.elem);
+	lock_release (&tid_table_lock);
+
 	/* Just set our status to dying and schedule another process.
 	   We will be destroyed during the call to schedule_tail(). */
 	intr_disable ();
+	fpu_release (thread_current ());
+	edf_util -= edf_utilization (thread_current ()->edf_runtime,
+			thread_current ()->edf_deadline);
 	do_schedule (THREAD_DYING);
 	NOT_REACHED ();
 }
 
 /* Yields the CPU.  The current thread is not put to sleep and
-   may be scheduled again immediately at the scheduler's whim. */
+   may be scheduled again immediately at the scheduler's whim,
+   unless it is a real-time thread that has been throttled. */
 void
 thread_yield (void) {
 	struct thread *curr = thread_current ();
@@ -362,13 +1155,21 @@ thread_yield (void) {
 	ASSERT (!intr_context ());
 
 	old_level = intr_disable ();
-	if (curr != idle_thread)
-    list_insert_ordered(&ready_list, &curr->elem, cmp_priority, NULL);
-	do_schedule (THREAD_READY);
+	if (curr->edf_throttled)
+		edf_sleep (curr);
+	else {
+		if (curr != this_cpu ()->idle_thread) {
+			curr->ready_since = timer_ticks ();
+			ready_push (curr);
+		}
+		do_schedule (THREAD_READY);
+	}
 	intr_set_level (old_level);
 }
 
 
+/* Blocks the current thread until timer tick TICKS.  Inserting
+   into sleep_wheel is O(1) regardless of the number of sleepers. */
 void thread_sleep(int64_t ticks) {
 	struct thread *curr = thread_current ();
 	enum intr_level old_level;
@@ -376,33 +1177,48 @@ void thread_sleep(int64_t ticks) {
 	ASSERT (!intr_context ());
 
 	old_level = intr_disable ();
-	if (curr != idle_thread) {
-		curr->wakeup_tick = ticks; 
-		list_insert_ordered(&sleep_list, &curr->elem, cmp_priority, NULL);
-		if (ticks < get_next_tick_to_awake())
-			update_next_tick_to_awake(ticks);
-	}
+	if (curr != this_cpu ()->idle_thread)
+		sleep_until (curr, ticks);
 	do_schedule (THREAD_BLOCKED);
 	intr_set_level (old_level);
 }
 
+/* Arranges for T, which is about to block, to be woken up at
+   timer tick TICKS. */
+static void
+sleep_until (struct thread *t, int64_t ticks) {
+	spinlock_acquire (&sleep_lock);
+	wheel_insert (&sleep_wheel, &t->sleep_elem, ticks);
+	update_next_tick_to_awake (wheel_next (&sleep_wheel));
+	spinlock_release (&sleep_lock);
+}
+
+/* Wakes up every thread whose wake up tick is at or before TICKS.
+   Called from the timer interrupt, so the work done is kept
+   proportional to the number of threads woken up.  A real-time
+   thread starting a new period preempts on the way out.
+
+   Unblocking takes a run queue lock, so the threads are collected
+   on their list elements, free while they sleep, and unblocked
+   after sleep_lock is dropped. */
 void thread_awake(int64_t ticks) {
-		struct list_elem *temp = list_begin(&sleep_list);
-		int64_t min_value = INT64_MAX;
-
-		while (temp != list_end(&sleep_list)) {
-			struct thread *cur = list_entry(temp, struct thread, elem);
-			if (cur->wakeup_tick <= ticks) {
-			  temp = list_remove(temp);
-				thread_unblock(cur);
-			} else {
-				if (cur->wakeup_tick < min_value) {
-					min_value = cur->wakeup_tick;
-				}
-				temp = list_next(temp);
-			}
-		}
-		update_next_tick_to_awake(min_value);
+	struct wheel_elem *e;
+	struct list woken;
+
+	list_init (&woken);
+	spinlock_acquire (&sleep_lock);
+	while ((e = wheel_pop_expired (&sleep_wheel, ticks)) != NULL)
+		list_push_back (&woken,
+				&wheel_entry (e, struct thread, sleep_elem)->elem);
+	update_next_tick_to_awake (wheel_next (&sleep_wheel));
+	spinlock_release (&sleep_lock);
+
+	while (!list_empty (&woken))
+		thread_unblock (list_entry (list_pop_front (&woken),
+					struct thread, elem));
+
+	if (edf_should_preempt ())
+		intr_yield_on_return ();
 }
 
 void update_next_tick_to_awake(int64_t ticks) {
@@ -413,53 +1229,332 @@ int64_t get_next_tick_to_awake(void) {
 	return next_tick_to_awake;
 }
 
-void donate_priority(void) {
-	struct thread *cur = thread_current();
-	int depth = 0;
-  int priority = cur->priority;
-	
-	while ((cur->wait_on_lock != NULL) && (depth < 8)) {
-		struct thread *nest_thread = cur->wait_on_lock->holder;
-    nest_thread->priority = priority;
-		cur = nest_thread;
-		depth++;
-	}
-}
-
-void remove_with_lock(struct lock *lock) {
-	struct thread *cur = thread_current();
-	struct list *cur_list = &cur->donations;
-	
-	if (!list_empty(cur_list)) {
-		struct list_elem *cur_elem = list_front(cur_list);
-		while (cur_elem != list_tail(cur_list)) {
-			struct thread *target_thread = list_entry(cur_elem, struct thread, donation_elem);
-
-			if (target_thread->wait_on_lock == lock) {
-				cur_elem = list_remove(&target_thread->donation_elem);
-			} else {
-				cur_elem = list_next(cur_elem);
-			}
-		}
+/* Priority donation.
+
+   Each lock keeps its waiters in a tree ordered by effective
+   priority, highest first, and caches the first waiter's priority
+   in lock->priority.  Each thread keeps the locks it holds in a
+   tree ordered by that cached priority, so a thread's effective
+   priority is the larger of its own priority and that of the
+   first lock in its held_locks, found in constant time.
+
+   When a thread's effective priority changes, only the lock it is
+   waiting for (if any) and that lock's holder are affected, and
+   the change moves on to the next lock in the chain only if it
+   changes the holder's effective priority in turn.  So a donation
+   follows a chain of any depth, stops as soon as it no longer
+   makes a difference, and costs O(log n) per step in the number
+   of waiters or locks involved.  Releasing a lock is one tree
+   removal and a recomputation.
+
+   A readers-writer lock has no single holder while it is read.
+   Each reader keeps a hold on it in its read_holds, another tree
+   ordered by donated priority, and a writer waiting for the
+   readers to leave donates to each of them through their holds,
+   from where the donation goes on along each reader's chain.
+
+   The trees are protected by disabling interrupts.  None of this
+   is used with -mlfqs, which does not donate. */
+
+/* lock->priority of a lock with no waiters. */
+#define NO_DONATION (PRI_MIN - 1)
+
+/* Orders threads by descending priority. */
+static bool
+donor_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = rbtree_entry (a_, struct thread, donor_elem);
+	const struct thread *b = rbtree_entry (b_, struct thread, donor_elem);
+
+	return a->priority > b->priority;
+}
+
+/* Orders locks by descending donated priority. */
+static bool
+held_lock_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct lock *a = rbtree_entry (a_, struct lock, holder_elem);
+	const struct lock *b = rbtree_entry (b_, struct lock, holder_elem);
+
+	return a->priority > b->priority;
+}
+
+/* Orders read holds by descending donated priority. */
+static bool
+read_hold_less (const struct rbtree_elem *a_, const struct rbtree_elem *b_,
+		void *aux UNUSED) {
+	const struct rwlock_hold *a
+		= rbtree_entry (a_, struct rwlock_hold, holder_elem);
+	const struct rwlock_hold *b
+		= rbtree_entry (b_, struct rwlock_hold, holder_elem);
+
+	return a->priority > b->priority;
+}
+
+/* Returns the priority that LOCK's waiters donate. */
+static int
+lock_donation (struct lock *lock) {
+	struct rbtree_elem *e = rbtree_min (&lock->waiters);
+
+	return e != NULL
+		? rbtree_entry (e, struct thread, donor_elem)->priority : NO_DONATION;
+}
+
+/* Returns T's effective priority: its own priority, or the
+   highest priority donated to it through a lock it holds or a
+   readers-writer lock it reads. */
+static int
+effective_priority (struct thread *t) {
+	struct rbtree_elem *e = rbtree_min (&t->held_locks);
+	int priority = t->init_priority;
+
+	if (e != NULL) {
+		int donated = rbtree_entry (e, struct lock, holder_elem)->priority;
+		if (donated > priority)
+			priority = donated;
+	}
+	e = rbtree_min (&t->read_holds);
+	if (e != NULL) {
+		int donated = rbtree_entry (e, struct rwlock_hold,
+				holder_elem)->priority;
+		if (donated > priority)
+			priority = donated;
+	}
+	return priority;
+}
+
+static void update_priority (struct thread *);
+
+/* Sets the priority that each reader of RW is donated through its
+   hold to PRIORITY, and carries the change along each reader's
+   chain.  Interrupts must be off. */
+static void
+donate_to_readers (struct rwlock *rw, int priority) {
+	struct list_elem *e;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (e = list_begin (&rw->readers_held); e != list_end (&rw->readers_held);
+			e = list_next (e)) {
+		struct rwlock_hold *h = list_entry (e, struct rwlock_hold, rw_elem);
+
+		if (h->priority == priority)
+			continue;
+		rbtree_remove (&h->holder->read_holds, &h->holder_elem);
+		h->priority = priority;
+		rbtree_insert (&h->holder->read_holds, &h->holder_elem);
+		update_priority (h->holder);
 	}
 }
 
-void refresh_priority(void) {
-	struct thread *cur = thread_current();
-  // * 원래 자신의 priority로 바꿔준다.
-	cur->priority = cur->init_priority;
+/* Recomputes T's effective priority and carries any change along
+   the chain of locks that T, and then each holder in turn, is
+   waiting for.  Interrupts must be off. */
+static void
+update_priority (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (;;) {
+		int priority = effective_priority (t);
+		struct lock *lock = t->wait_on_lock;
+		int donation;
+
+		if (priority == t->priority)
+			return;
+		if (t->wait_on_readers != NULL) {
+			set_priority (t, priority);
+			donate_to_readers (t->wait_on_readers, priority);
+			return;
+		}
+		if (lock == NULL) {
+			set_priority (t, priority);
+			return;
+		}
 
-	struct list *cur_list = &cur->donations;
-	int max_priority = cur->priority;
-	if(!list_empty(cur_list)) {
-		struct list_elem *cur_elem = list_front(cur_list);
-		while (cur_elem != list_tail(cur_list)) {
-			struct thread *target_thread = list_entry(cur_elem, struct thread, donation_elem);
-      max_priority = target_thread->priority;
-			cur_elem = list_next(cur_elem);
+		/* T's key in LOCK's waiters changes. */
+		rbtree_remove (&lock->waiters, &t->donor_elem);
+		set_priority (t, priority);
+		rbtree_insert (&lock->waiters, &t->donor_elem);
+
+		/* And maybe so does LOCK's key in its holder's locks. */
+		donation = lock_donation (lock);
+		if (donation == lock->priority)
+			return;
+		t = lock->holder;
+		if (t == NULL) {
+			lock->priority = donation;
+			return;
 		}
-    cur->priority = max_priority;
+		rbtree_remove (&t->held_locks, &lock->holder_elem);
+		lock->priority = donation;
+		rbtree_insert (&t->held_locks, &lock->holder_elem);
+	}
+}
+
+/* Sets LOCK->holder's place in the holder's held_locks after
+   LOCK's waiters changed, and updates its priority to match. */
+static void
+update_lock (struct lock *lock) {
+	int donation = lock_donation (lock);
+	struct thread *holder = lock->holder;
+
+	if (donation == lock->priority)
+		return;
+	if (holder == NULL) {
+		lock->priority = donation;
+		return;
+	}
+	rbtree_remove (&holder->held_locks, &lock->holder_elem);
+	lock->priority = donation;
+	rbtree_insert (&holder->held_locks, &lock->holder_elem);
+	update_priority (holder);
+}
+
+/* Initializes LOCK's donation state. */
+void
+donation_init (struct lock *lock) {
+	rbtree_init (&lock->waiters, donor_less, NULL);
+	lock->priority = NO_DONATION;
+}
+
+/* Records that the current thread is about to wait for LOCK, and
+   donates its priority to LOCK's holder. */
+void
+donation_wait (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (cur->wait_on_lock == NULL);
+	cur->wait_on_lock = lock;
+	rbtree_insert (&lock->waiters, &cur->donor_elem);
+	update_lock (lock);
+	intr_set_level (old_level);
+}
+
+/* Records that the current thread has acquired LOCK, whether or
+   not it had to wait for it.  Any threads still waiting for LOCK
+   now donate to the current thread. */
+void
+donation_acquire (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	if (cur->wait_on_lock != NULL) {
+		ASSERT (cur->wait_on_lock == lock);
+		rbtree_remove (&lock->waiters, &cur->donor_elem);
+		cur->wait_on_lock = NULL;
+	}
+	lock->priority = lock_donation (lock);
+	rbtree_insert (&cur->held_locks, &lock->holder_elem);
+	update_priority (cur);
+	intr_set_level (old_level);
+}
+
+/* Takes back the current thread's donation to LOCK's holder,
+   after it gave up waiting for LOCK without getting it. */
+void
+donation_cancel (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	if (cur->wait_on_lock != NULL) {
+		ASSERT (cur->wait_on_lock == lock);
+		rbtree_remove (&lock->waiters, &cur->donor_elem);
+		cur->wait_on_lock = NULL;
+		update_lock (lock);
+	}
+	intr_set_level (old_level);
+}
+
+/* Records that the current thread is releasing LOCK, and takes
+   back whatever priority was donated through it. */
+void
+donation_release (struct lock *lock) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	rbtree_remove (&cur->held_locks, &lock->holder_elem);
+	update_priority (cur);
+	intr_set_level (old_level);
+}
+
+/* Returns the current thread's hold on RW, or a null pointer if
+   it has none.  Interrupts must be off. */
+static struct rwlock_hold *
+find_read_hold (struct rwlock *rw) {
+	struct thread *cur = thread_current ();
+
+	for (int i = 0; i < THREAD_RW_HOLDS; i++)
+		if (cur->rw_holds[i].rw == rw)
+			return &cur->rw_holds[i];
+	return NULL;
+}
+
+/* Records that the current thread has acquired RW for reading.
+   No writer can be waiting for RW's readers meanwhile, since a
+   reader gets in only while holding RW's lock. */
+void
+donation_read_acquire (struct rwlock *rw) {
+	enum intr_level old_level = intr_disable ();
+	struct rwlock_hold *h = find_read_hold (rw);
+
+	if (h == NULL && (h = find_read_hold (NULL)) != NULL) {
+		h->rw = rw;
+		h->holder = thread_current ();
+		h->depth = 0;
+		h->priority = NO_DONATION;
+		list_push_back (&rw->readers_held, &h->rw_elem);
+		rbtree_insert (&h->holder->read_holds, &h->holder_elem);
+	}
+	if (h != NULL)
+		h->depth++;
+	intr_set_level (old_level);
+}
+
+/* Records that the current thread is releasing RW for reading,
+   and takes back whatever priority was donated through its hold
+   once it lets go for the last time. */
+void
+donation_read_release (struct rwlock *rw) {
+	enum intr_level old_level = intr_disable ();
+	struct rwlock_hold *h = find_read_hold (rw);
+
+	if (h != NULL && --h->depth == 0) {
+		list_remove (&h->rw_elem);
+		rbtree_remove (&h->holder->read_holds, &h->holder_elem);
+		h->rw = NULL;
+		update_priority (h->holder);
 	}
+	intr_set_level (old_level);
+}
+
+/* Records that the current thread, holding RW's lock, is about to
+   wait for RW's readers to leave, and donates its priority to
+   them.  Interrupts must be off, and stay off until the wait
+   begins, so that no reader leaves unnoticed. */
+void
+donation_readers_wait (struct rwlock *rw) {
+	struct thread *cur = thread_current ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (cur->wait_on_readers == NULL);
+
+	cur->wait_on_readers = rw;
+	donate_to_readers (rw, cur->priority);
+}
+
+/* Records that the current thread has stopped waiting for RW's
+   readers, because they left or because it gave up, and takes
+   back its donation to any that remain. */
+void
+donation_readers_done (struct rwlock *rw) {
+	struct thread *cur = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (cur->wait_on_readers == rw);
+	cur->wait_on_readers = NULL;
+	donate_to_readers (rw, NO_DONATION);
+	intr_set_level (old_level);
 }
 
 /* Sets the current thread's priority to NEW_PRIORITY. */
@@ -467,10 +1562,10 @@ void
 thread_set_priority (int new_priority) {
   // * mlfqs 스케줄러 일때 우선순위를 임의로 변경할 수 없도록 한다.
  if(!thread_mlfqs) {
+  enum intr_level old_level = intr_disable ();
   thread_current ()->init_priority = new_priority;
-  // * 추가 코드
-  refresh_priority();
-  donate_priority();
+  update_priority (thread_current ());
+  intr_set_level (old_level);
   test_max_priority();
  }
 }
@@ -498,9 +1593,15 @@ thread_set_nice (int nice UNUSED) {
 	old_level = intr_disable ();
   struct thread *cur = thread_current();
   cur->nice = nice;
-  mlfqs_priority(cur);
-  if (cur->priority < list_entry(list_begin(&ready_list), struct thread, elem)->priority) {
-    thread_yield();
+  if (thread_fair) {
+    /* Only the weight changes; vruntime so far stays. */
+    if (fair_should_preempt ())
+      thread_yield ();
+  } else {
+    mlfqs_priority(cur);
+    if (cur->priority < ready_max_priority ()) {
+      thread_yield();
+    }
   }
   intr_set_level (old_level);
 }
@@ -508,47 +1609,30 @@ thread_set_nice (int nice UNUSED) {
 /* Returns the current thread's nice value. */
 int
 thread_get_nice (void) {
-	/* TODO: Your implementation goes here */
-  /*
-   * 현재 스레드의 nice 값을 반환한다.
-   * 해당 작업중에 인터럽트는 비활성되어야 한다.
-   */
-	enum intr_level old_level;
-	old_level = intr_disable ();
-  struct thread *cur = thread_current();
-
-  intr_set_level (old_level);
-  return cur->nice;
+	/* Only the thread itself sets its nice value, so reading it
+	   needs no protection. */
+	return thread_current ()->nice;
 }
 
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void) {
-	/* TODO: Your implementation goes here */
-  /* 
-   * load_avg에 100을 곱해서 반환 한다.
-   * 해당 과정중에 인터럽트는 비활성되어야 한다.
-   */
-	enum intr_level old_level;
-	old_level = intr_disable ();
-  int value = mult_mixed(load_avg, 100);
-  intr_set_level (old_level);
-  return fp_to_int_round(value);
+	/* load_avg is one word, which the timer interrupt replaces
+	   whole, so one read of it is consistent without holding off
+	   the interrupt. */
+	int value = mult_mixed (load_avg, 100);
+
+	return fp_to_int_round (value);
 }
 
 /* Returns 100 times the current thread's recent_cpu value. */
 int
 thread_get_recent_cpu (void) {
-	/* TODO: Your implementation goes here */
-  /* 
-   * recent_cpu 에 100을 곱해서 반환 한다.
-   * 해당 과정중에 인터럽트는 비활성되어야 한다.
-   */
-  enum intr_level old_level;
-	old_level = intr_disable ();
-  int value = mult_mixed(thread_current()->recent_cpu, 100);
-  intr_set_level (old_level);
-  return fp_to_int_round(value);
+	/* Likewise for recent_cpu, which the timer interrupt updates
+	   for the running thread. */
+	int value = mult_mixed (thread_current ()->recent_cpu, 100);
+
+	return fp_to_int_round (value);
 }
 
 /* Idle thread.  Executes when no other thread is ready to run.
@@ -564,7 +1648,7 @@ static void
 idle (void *idle_started_ UNUSED) {
 	struct semaphore *idle_started = idle_started_;
 
-	idle_thread = thread_current ();
+	this_cpu ()->idle_thread = thread_current ();
 	sema_up (idle_started);
 
 	for (;;) {
@@ -572,6 +1656,10 @@ idle (void *idle_started_ UNUSED) {
 		intr_disable ();
 		thread_block ();
 
+		/* Nothing to run.  In tickless mode, don't take another
+		   timer interrupt until one is needed. */
+		timer_idle_enter ();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -584,7 +1672,9 @@ idle (void *idle_started_ UNUSED) {
 
 		   See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
 		   7.11.1 "HLT Instruction". */
+		intr_trace_sti ();
 		asm volatile ("sti; hlt" : : : "memory");
+		timer_idle_exit ();
 	}
 }
 
@@ -602,7 +1692,7 @@ kernel_thread (thread_func *function, void *aux) {
 /* Does basic initialization of T as a blocked thread named
    NAME. */
 static void
-init_thread (struct thread *t, const char *name, int priority, int wakeup_tick) {
+init_thread (struct thread *t, const char *name, int priority) {
 	ASSERT (t != NULL);
 	ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
 	ASSERT (name != NULL);
@@ -610,16 +1700,19 @@ init_thread (struct thread *t, const char *name, int priority, int wakeup_tick)
 	memset (t, 0, sizeof *t);
 	t->status = THREAD_BLOCKED;
 	strlcpy (t->name, name, sizeof t->name);
-	t->tf.rsp = (uint64_t) t + PGSIZE - sizeof (void *);
 	t->priority = priority;
 	t->init_priority = priority;
 	t->wait_on_lock = NULL;
+	t->wait_on_sema = NULL;
+	t->cond_waiter = NULL;
   // * Advanced Scheduler 구현
   t->nice = NICE_DEFAULT;
   t->recent_cpu = RECENT_CPU_DEFAULT;
+  t->decay_epoch = decay_epoch;
 
-	list_init(&t->donations);
-	t->wakeup_tick = wakeup_tick;
+	rbtree_init (&t->held_locks, held_lock_less, NULL);
+	rbtree_init (&t->read_holds, read_hold_less, NULL);
+	seqlock_init (&t->sched_seq);
 	t->magic = THREAD_MAGIC;
 
   // * USERPROG 추가
@@ -631,13 +1724,13 @@ init_thread (struct thread *t, const char *name, int priority, int wakeup_tick)
    return a thread from the run queue, unless the run queue is
    empty.  (If the running thread can continue running, then it
    will be in the run queue.)  If the run queue is empty, return
-   idle_thread. */
+   this CPU's idle thread. */
 static struct thread *
 next_thread_to_run (void) {
-	if (list_empty (&ready_list))
-		return idle_thread;
-	else
-		return list_entry (list_pop_front (&ready_list), struct thread, elem);
+	struct cpu *c = this_cpu ();
+	struct thread *t = ready_pop (c);
+
+	return t != NULL ? t : c->idle_thread;
 }
 
 /* Use iretq to launch the thread */
@@ -668,73 +1761,17 @@ do_iret (struct intr_frame *tf) {
 			: : "g" ((uint64_t) tf) : "memory");
 }
 
-/* Switching the thread by activating the new thread's page
-   tables, and, if the previous thread is dying, destroying it.
+/* Switches from the running thread to TH, which must not be
+   running.  Returns when the running thread is next scheduled.
 
-   At this function's invocation, we just switched from thread
-   PREV, the new thread is already running, and interrupts are
-   still disabled.
-
-   It's not safe to call printf() until the thread switch is
-   complete.  In practice that means that printf()s should be
-   added at the end of the function. */
+   Both threads are in kernel mode here, so only the registers
+   that schedule()'s caller expects to survive have to be saved;
+   see threads/switch.h.  Interrupts must be off. */
 static void
 thread_launch (struct thread *th) {
-	uint64_t tf_cur = (uint64_t) &running_thread ()->tf;
-	uint64_t tf = (uint64_t) &th->tf;
 	ASSERT (intr_get_level () == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile (
-			/* Store registers that will be used. */
-			"push %%rax\n"
-			"push %%rbx\n"
-			"push %%rcx\n"
-			/* Fetch input once */
-			"movq %0, %%rax\n"
-			"movq %1, %%rcx\n"
-			"movq %%r15, 0(%%rax)\n"
-			"movq %%r14, 8(%%rax)\n"
-			"movq %%r13, 16(%%rax)\n"
-			"movq %%r12, 24(%%rax)\n"
-			"movq %%r11, 32(%%rax)\n"
-			"movq %%r10, 40(%%rax)\n"
-			"movq %%r9, 48(%%rax)\n"
-			"movq %%r8, 56(%%rax)\n"
-			"movq %%rsi, 64(%%rax)\n"
-			"movq %%rdi, 72(%%rax)\n"
-			"movq %%rbp, 80(%%rax)\n"
-			"movq %%rdx, 88(%%rax)\n"
-			"pop %%rbx\n"              // Saved rcx
-			"movq %%rbx, 96(%%rax)\n"
-			"pop %%rbx\n"              // Saved rbx
-			"movq %%rbx, 104(%%rax)\n"
-			"pop %%rbx\n"              // Saved rax
-			"movq %%rbx, 112(%%rax)\n"
-			"addq $120, %%rax\n"
-			"movw %%es, (%%rax)\n"
-			"movw %%ds, 8(%%rax)\n"
-			"addq $32, %%rax\n"
-			"call __next\n"         // read the current rip.
-			"__next:\n"
-			"pop %%rbx\n"
-			"addq $(out_iret -  __next), %%rbx\n"
-			"movq %%rbx, 0(%%rax)\n" // rip
-			"movw %%cs, 8(%%rax)\n"  // cs
-			"pushfq\n"
-			"popq %%rbx\n"
-			"mov %%rbx, 16(%%rax)\n" // eflags
-			"mov %%rsp, 24(%%rax)\n" // rsp
-			"movw %%ss, 32(%%rax)\n"
-			"mov %%rcx, %%rdi\n"
-			"call do_iret\n"
-			"out_iret:\n"
-			: : "g"(tf_cur), "g" (tf) : "memory"
-			);
+	switch_threads (&running_thread ()->ksp, th->ksp);
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -743,12 +1780,17 @@ thread_launch (struct thread *th) {
  * It's not safe to call printf() in the schedule(). */
 static void
 do_schedule(int status) {
+	struct list *destruction_req = &this_cpu ()->destruction_req;
+
 	ASSERT (intr_get_level () == INTR_OFF);
 	ASSERT (thread_current()->status == THREAD_RUNNING);
-	while (!list_empty (&destruction_req)) {
+	while (!list_empty (destruction_req)) {
 		struct thread *victim =
-			list_entry (list_pop_front (&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+			list_entry (list_pop_front (destruction_req), struct thread, elem);
+		if (victim->fdt != NULL)
+			fdt_free (victim->fdt);
+		victim->magic = 0;
+		kstack_free (victim);
 	}
 	thread_current ()->status = status;
 	schedule ();
@@ -756,17 +1798,37 @@ do_schedule(int status) {
 
 static void
 schedule (void) {
+	struct cpu *c = this_cpu ();
 	struct thread *curr = running_thread ();
-	struct thread *next = next_thread_to_run ();
+	struct thread *next;
 
 	ASSERT (intr_get_level () == INTR_OFF);
+
+	/* An interrupt that ended the idle thread's halt may yield to
+	   the thread it woke without returning to idle().  Bring `ticks'
+	   up to date and end the tickless one-shot here, so that the
+	   thread gets its time slices and is not charged as idle. */
+	if (curr == c->idle_thread)
+		timer_idle_exit ();
+	else if (thread_mlfqs && curr->status == THREAD_BLOCKED) {
+		/* The idle thread is never unblocked, and its recent_cpu
+		   does not matter, so it is left out. */
+		spinlock_acquire (&blocked_lock);
+		list_push_back (&blocked_list, &curr->blocked_elem);
+		spinlock_release (&blocked_lock);
+		curr->on_blocked_list = true;
+	}
+
+	next = next_thread_to_run ();
 	ASSERT (curr->status != THREAD_RUNNING);
 	ASSERT (is_thread (next));
+	sched_account (c, curr, next);
 	/* Mark us as running. */
 	next->status = THREAD_RUNNING;
 
 	/* Start new time slice. */
-	thread_ticks = 0;
+	c->thread_ticks = 0;
+	c->running = next;
 
 #ifdef USERPROG
 	/* Activate the new address space. */
@@ -783,79 +1845,263 @@ schedule (void) {
 		   schedule(). */
 		if (curr && curr->status == THREAD_DYING && curr != initial_thread) {
 			ASSERT (curr != next);
-			list_push_back (&destruction_req, &curr->elem);
+			list_push_back (&c->destruction_req, &curr->elem);
 		}
 
 		/* Before switching the thread, we first save the information
 		 * of current running. */
+		fpu_switch (next);
 		thread_launch (next);
 	}
 }
 
+/* Updates scheduling statistics as C switches from PREV to NEXT:
+   counts PREV's switch as voluntary if it blocked or involuntary
+   if it is still ready, and charges NEXT for the time it spent
+   waiting in the run queue. */
+static void
+sched_account (struct cpu *c, struct thread *prev, struct thread *next) {
+	if (prev != next && prev != c->idle_thread) {
+		sched_write_begin (c, prev);
+		if (prev->status == THREAD_BLOCKED) {
+			prev->sched.nvcsw++;
+			c->sched.nvcsw++;
+		} else if (prev->status == THREAD_READY) {
+			prev->sched.nivcsw++;
+			c->sched.nivcsw++;
+		}
+		sched_write_end (c, prev);
+	}
+
+	if (next != c->idle_thread) {
+		int64_t wait = timer_ticks () - next->ready_since;
+
+		sched_write_begin (c, next);
+		next->sched.wait_ticks += wait;
+		c->sched.wait_ticks += wait;
+		if (next->woken) {
+			next->woken = false;
+			sched_record_wakeup (&next->sched, wait);
+			sched_record_wakeup (&c->sched, wait);
+		}
+		sched_write_end (c, next);
+	}
+}
+
+/* Begins an update to the scheduling statistics of C and of T,
+   which runs or is being switched to or from on C.  Only C ever
+   updates them then, with interrupts off, so the updates need no
+   lock; the seqlocks only let thread_sched_stats() read them
+   without turning interrupts off. */
+static void
+sched_write_begin (struct cpu *c, struct thread *t) {
+	seqlock_write_begin (&t->sched_seq);
+	seqlock_write_begin (&c->sched_seq);
+}
+
+/* Ends an update begun by sched_write_begin(). */
+static void
+sched_write_end (struct cpu *c, struct thread *t) {
+	seqlock_write_end (&c->sched_seq);
+	seqlock_write_end (&t->sched_seq);
+}
+
+/* Copies the scheduling statistics SRC, guarded by SEQ, to DST. */
+static void
+sched_stats_copy (const struct seqlock *seq, const struct sched_stats *src,
+		struct sched_stats *dst) {
+	uint32_t start;
+
+	do {
+		start = seqlock_read_begin (seq);
+		*dst = *src;
+	} while (seqlock_read_retry (seq, start));
+}
+
+/* Adds a wakeup that took LATENCY ticks to run to S. */
+static void
+sched_record_wakeup (struct sched_stats *s, int64_t latency) {
+	int bucket = latency > 0 ? bsrq (latency) + 1 : 0;
+
+	if (bucket >= SCHED_LAT_BUCKETS)
+		bucket = SCHED_LAT_BUCKETS - 1;
+	s->lat_hist[bucket]++;
+	s->wakeup_cnt++;
+	if (latency > s->lat_max)
+		s->lat_max = latency;
+}
+
+/* Returns an empty file descriptor table, or a null pointer if
+   memory is exhausted. */
+struct file **
+fdt_alloc (void) {
+	return objcache_get (&fdt_cache);
+}
+
+/* Frees file descriptor table FDT, whose files must all have been
+   closed.  May be called with interrupts off. */
+void
+fdt_free (struct file **fdt) {
+	objcache_put (&fdt_cache, fdt);
+}
+
+/* Allocates a new, zeroed, file descriptor table for fdt_cache. */
+static void *
+fdt_create (void) {
+	return palloc_get_page (PAL_ZERO);
+}
+
+/* Frees FDT, for which fdt_cache has no room. */
+static void
+fdt_destroy (void *fdt) {
+	palloc_free_page (fdt);
+}
+
+/* Hashes an entry in tid_table by tid. */
+static uint64_t
+tid_hash (const struct hash_elem *e, void *aux UNUSED) {
+	return hash_int (hash_entry (e, struct tid_entry, elem)->tid);
+}
+
+/* Orders entries in tid_table by tid. */
+static bool
+tid_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct tid_entry, elem)->tid
+		< hash_entry (b, struct tid_entry, elem)->tid;
+}
+
+/* Adds T to tid_table. */
+static void
+tid_table_insert (struct thread *t) {
+	t->tid_entry.tid = t->tid;
+	lock_acquire (&tid_table_lock);
+	hash_insert (&tid_table, &t->tid_entry.elem);
+	lock_release (&tid_table_lock);
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid (void) {
-	static tid_t next_tid = 1;
-	tid_t tid;
-
-	lock_acquire (&tid_lock);
-	tid = next_tid++;
-	lock_release (&tid_lock);
+	static volatile uint32_t next_tid = 1;
 
-	return tid;
+	return xaddl (&next_tid, 1);
 }
 
 // * Advanced Scheduler 함수 추가
+static int
+mlfqs_calc_priority(const struct thread *t) {
+  // * priority 계산식을 구현 (fixed_point.h의 계산함수 이용)
+  int priority = fp_to_int(int_to_fp(PRI_MAX) - (div_mixed(t->recent_cpu, 4)) - int_to_fp(t->nice * 2));
+  priority = priority > PRI_MIN ? priority : PRI_MIN;
+  priority = priority < PRI_MAX ? priority : PRI_MAX;
+  return priority;
+}
+
 void mlfqs_priority(struct thread *t) {
-  if (t != idle_thread) {
-    // * priority 계산식을 구현 (fixed_point.h의 계산함수 이용)
-    t->priority = fp_to_int(int_to_fp(PRI_MAX) - (div_mixed(t->recent_cpu, 4)) - int_to_fp(t->nice * 2));
-    t->priority = t->priority > PRI_MIN ? t->priority : PRI_MIN;
-    t->priority = t->priority < PRI_MAX ? t->priority : PRI_MAX;
-  }
+  if (!is_idle_thread (t))
+    set_priority (t, mlfqs_calc_priority (t));
 }
 
+/* Applies to T's recent_cpu every decay recorded since T was
+   last brought up to date. */
 void mlfqs_recent_cpu(struct thread *t) {
-  if (t != idle_thread) {
-    // * recent_cpu 계산식을 구현 (fixed_point.h의 계산함수 이용)
-    t->recent_cpu = mult_fp(div_fp(mult_mixed(load_avg, 2), (mult_mixed(load_avg, 2) + int_to_fp(1))), t->recent_cpu) + int_to_fp(t->nice);
-  }
+  int64_t epoch = t->decay_epoch;
+
+  ASSERT (decay_epoch - epoch <= DECAY_HISTORY);
+  // * recent_cpu 계산식을 구현 (fixed_point.h의 계산함수 이용)
+  for (; epoch < decay_epoch; epoch++)
+    t->recent_cpu = mult_fp (decay_coef[epoch % DECAY_HISTORY], t->recent_cpu)
+                    + int_to_fp (t->nice);
+  t->decay_epoch = decay_epoch;
 }
 
 void mlfqs_load_avg(void) {
   // * load_avg 계산식을 구현
   // * load_avg는 0보다 작아질 수 없다.
-  int num = list_size(&ready_list);
-  if (thread_current() != idle_thread)
-    num += 1;
+  int num = 0;
+  for (unsigned id = 0; id < cpu_cnt; id++) {
+    num += cpus[id].ready_cnt;
+    if (cpus[id].running != cpus[id].idle_thread)
+      num += 1;
+  }
   load_avg = mult_fp (div_mixed(int_to_fp (59), 60), load_avg) + mult_mixed (div_mixed(int_to_fp(1), 60), num);
 }
 
 void mlfqs_increment(void) {
   struct thread *cur = thread_current();
-  if (cur != idle_thread) {
+  if (cur != this_cpu ()->idle_thread) {
     cur->recent_cpu = add_mixed(cur->recent_cpu, 1);
   }
 }
 
-void mlfqs_recalc(void) {
-  // * 모든 thread의 recent_cpu와 priority값 재계산
-  struct thread *cur = thread_current();
-  mlfqs_recent_cpu(cur);
-  mlfqs_priority(cur);
-  struct list_elem *ready = list_begin(&ready_list);
-  struct thread *ready_thread;
-  while (ready != list_tail(&ready_list)) {
-	ready_thread = list_entry(ready, struct thread, elem);
-    mlfqs_recent_cpu(ready_thread);
-    mlfqs_priority(ready_thread);
-    ready = list_next(ready);
+/* Recomputes recent_cpu and priority of every thread in C's run
+   queue and of the thread running on C. */
+static void
+mlfqs_recalc_cpu (struct cpu *c) {
+  struct thread *running = c->running;
+
+  if (running != NULL && running != c->idle_thread) {
+    mlfqs_recent_cpu (running);
+    mlfqs_priority (running);
   }
 
-  struct list_elem *sleep = list_begin(&sleep_list);
-  while (sleep != list_tail(&sleep_list)) {
-    mlfqs_recent_cpu(list_entry(sleep, struct thread, elem));
-    mlfqs_priority(list_entry(sleep, struct thread, elem));
-    sleep = list_next(sleep);
+  spinlock_acquire (&c->rq_lock);
+  if (thread_ready_list) {
+    struct list_elem *ready = list_begin(&c->ready_list);
+    struct thread *ready_thread;
+    while (ready != list_tail(&c->ready_list)) {
+      ready_thread = list_entry(ready, struct thread, elem);
+      mlfqs_recent_cpu(ready_thread);
+      ready_thread->priority = mlfqs_calc_priority (ready_thread);
+      ready = list_next(ready);
+    }
+  } else {
+    /* Recomputing a priority moves the thread to another queue,
+       possibly one not visited yet, so take a snapshot of every
+       ready thread first and requeue each one exactly once. */
+    struct list ready;
+    list_init (&ready);
+    for (int pri = PRI_MAX; pri >= PRI_MIN; pri--)
+      while (!list_empty (&c->ready_queues[pri]))
+        list_push_back (&ready, list_pop_front (&c->ready_queues[pri]));
+    c->ready_mask = 0;
+    while (!list_empty (&ready)) {
+      struct thread *t = list_entry (list_pop_front (&ready), struct thread, elem);
+      mlfqs_recent_cpu (t);
+      t->priority = mlfqs_calc_priority (t);
+      rq_insert (c, t);
+    }
   }
-}
\ No newline at end of file
+  spinlock_release (&c->rq_lock);
+}
+
+/* Brings every blocked thread's recent_cpu up to date, so that
+   the coefficients recorded so far are no longer needed.  Their
+   priorities are left alone: decay_epoch moves on right after, so
+   thread_unblock() still recomputes them. */
+static void
+mlfqs_catch_up_blocked (void) {
+  spinlock_acquire (&blocked_lock);
+  for (struct list_elem *e = list_begin (&blocked_list);
+       e != list_end (&blocked_list); e = list_next (e))
+    mlfqs_recent_cpu (list_entry (e, struct thread, blocked_elem));
+  spinlock_release (&blocked_lock);
+}
+
+/* Starts a new decay epoch and brings the threads that can be
+   scheduled up to date.  Blocked threads are updated lazily, by
+   thread_unblock(), or when the oldest recorded coefficient is
+   about to be overwritten. */
+void mlfqs_recalc(void) {
+  int twice_load = mult_mixed (load_avg, 2);
+
+  if (decay_epoch % DECAY_HISTORY == 0)
+    mlfqs_catch_up_blocked ();
+  decay_coef[decay_epoch % DECAY_HISTORY] =
+    div_fp (twice_load, add_mixed (twice_load, 1));
+  decay_epoch++;
+
+  for (unsigned id = 0; id < cpu_cnt; id++)
+    mlfqs_recalc_cpu (&cpus[id]);
+}
@@ -0,0 +1,273 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+
+/* A thread waiting in workqueue_flush(). */
+struct flusher {
+	struct list_elem elem;          /* Element in wq->flushers. */
+	int64_t seq;                    /* Waits for items up to this seq. */
+	struct semaphore done;          /* Up'd when they have all run. */
+};
+
+struct workqueue system_wq;
+
+static thread_func worker_main;
+static bool flush_done (struct workqueue *, int64_t seq);
+static void finish_flushers (struct workqueue *, struct list *done);
+static void wake_flushers (struct list *done);
+static struct work *start_item (struct worker *, struct list *batch);
+
+/* Initializes WQ, named NAME, and starts WORKER_CNT worker
+   threads for it at the given PRIORITY. */
+void
+workqueue_init (struct workqueue *wq, const char *name, int priority,
+		size_t worker_cnt) {
+	ASSERT (wq != NULL);
+	ASSERT (name != NULL);
+	ASSERT (worker_cnt > 0 && worker_cnt <= WORKQUEUE_MAX_WORKERS);
+
+	wq->name = name;
+	wq->worker_cnt = worker_cnt;
+	spinlock_init (&wq->lock);
+	list_init (&wq->pending);
+	list_init (&wq->idle);
+	list_init (&wq->flushers);
+	wq->next_seq = 0;
+	wq->queue_cnt = wq->batch_cnt = 0;
+	wq->max_batch = 0;
+
+	for (size_t i = 0; i < worker_cnt; i++) {
+		struct worker *w = &wq->workers[i];
+		char thread_name[16];
+
+		w->wq = wq;
+		sema_init (&w->wake, 0);
+		w->active_seq = INT64_MAX;
+		snprintf (thread_name, sizeof thread_name, "%s/%zu", name, i);
+		w->tid = thread_create (thread_name, priority, worker_main, w);
+		ASSERT (w->tid != TID_ERROR);
+	}
+}
+
+/* Initializes W to run FUNC when queued. */
+void
+work_init (struct work *w, work_func *func) {
+	ASSERT (w != NULL);
+	ASSERT (func != NULL);
+
+	w->func = func;
+	w->wq = NULL;
+}
+
+/* Queues W on WQ, unless W is already queued, and returns true if
+   it was queued.  Never sleeps, so it may be called from an
+   interrupt handler. */
+bool
+workqueue_queue (struct workqueue *wq, struct work *w) {
+	struct worker *idle = NULL;
+
+	ASSERT (wq != NULL);
+	ASSERT (w != NULL && w->func != NULL);
+
+	spinlock_acquire (&wq->lock);
+	if (w->wq != NULL) {
+		spinlock_release (&wq->lock);
+		return false;
+	}
+	w->wq = wq;
+	w->seq = wq->next_seq++;
+	list_push_back (&wq->pending, &w->elem);
+	wq->queue_cnt++;
+	if (!list_empty (&wq->idle))
+		idle = list_entry (list_pop_front (&wq->idle), struct worker, idle_elem);
+	spinlock_release (&wq->lock);
+
+	if (idle != NULL)
+		sema_up (&idle->wake);
+	return true;
+}
+
+/* Removes W from the queue it is pending on, if any, and returns
+   true if it did.  An item that a worker has taken in a batch but
+   not yet started is still pending.  Does not wait for W if it is
+   already running; use workqueue_flush() for that. */
+bool
+workqueue_cancel (struct work *w) {
+	struct workqueue *wq;
+	struct list done;
+	bool canceled = false;
+
+	ASSERT (w != NULL);
+
+	wq = w->wq;
+	if (wq == NULL)
+		return false;
+
+	/* W may have been started before we got the lock.  If not,
+	   it is in WQ's pending list or in a worker's batch. */
+	list_init (&done);
+	spinlock_acquire (&wq->lock);
+	if (w->wq == wq) {
+		list_remove (&w->elem);
+		w->wq = NULL;
+		canceled = true;
+		finish_flushers (wq, &done);
+	}
+	spinlock_release (&wq->lock);
+	wake_flushers (&done);
+	return canceled;
+}
+
+/* Waits until every item queued on WQ before this call has run.
+   Items queued meanwhile are not waited for.  Must not be called
+   from one of WQ's own work functions. */
+void
+workqueue_flush (struct workqueue *wq) {
+	struct flusher f;
+
+	ASSERT (!intr_context ());
+	for (size_t i = 0; i < wq->worker_cnt; i++)
+		ASSERT (wq->workers[i].tid != thread_tid ());
+
+	spinlock_acquire (&wq->lock);
+	f.seq = wq->next_seq - 1;
+	if (flush_done (wq, f.seq)) {
+		spinlock_release (&wq->lock);
+		return;
+	}
+	sema_init (&f.done, 0);
+	list_push_back (&wq->flushers, &f.elem);
+	spinlock_release (&wq->lock);
+	sema_down (&f.done);
+}
+
+/* Returns true if W is queued and has not yet started to run. */
+bool
+work_pending (const struct work *w) {
+	return w->wq != NULL;
+}
+
+/* Prints statistics for WQ. */
+void
+workqueue_print_stats (struct workqueue *wq) {
+	printf ("Workqueue %s: %lld items queued, %lld batches, "
+			"largest batch %zu\n",
+			wq->name, wq->queue_cnt, wq->batch_cnt, wq->max_batch);
+}
+
+/* A worker thread's main loop: takes a batch of items off the
+   queue and runs them, or sleeps until there are some. */
+static void
+worker_main (void *self_) {
+	struct worker *self = self_;
+	struct workqueue *wq = self->wq;
+
+	for (;;) {
+		struct list batch;
+		struct work *w;
+		size_t cnt = 0;
+
+		/* The items taken stay pending, with their wq set, until
+		   start_item() takes them off BATCH to run, so until then
+		   they can be canceled but not queued a second time. */
+		list_init (&batch);
+		spinlock_acquire (&wq->lock);
+		while (!list_empty (&wq->pending) && cnt < WORK_BATCH_MAX) {
+			list_push_back (&batch, list_pop_front (&wq->pending));
+			cnt++;
+		}
+		if (cnt == 0) {
+			/* Nothing to do.  Wait to be woken by
+			   workqueue_queue(). */
+			list_push_back (&wq->idle, &self->idle_elem);
+			spinlock_release (&wq->lock);
+			sema_down (&self->wake);
+			continue;
+		}
+		wq->batch_cnt++;
+		if (cnt > wq->max_batch)
+			wq->max_batch = cnt;
+		w = start_item (self, &batch);
+		spinlock_release (&wq->lock);
+
+		while (w != NULL) {
+			struct list done;
+
+			/* W may be freed or queued again by its function, so
+			   nothing in it may be used afterward. */
+			w->func (w);
+
+			list_init (&done);
+			spinlock_acquire (&wq->lock);
+			w = start_item (self, &batch);
+			finish_flushers (wq, &done);
+			spinlock_release (&wq->lock);
+			wake_flushers (&done);
+		}
+	}
+}
+
+/* Takes the next item off SELF's BATCH to run and returns it, or
+   returns a null pointer if BATCH is empty, which it may be even
+   before the last item ran if the rest were canceled.  From here
+   on the item may be queued again.  The queue's lock must be
+   held. */
+static struct work *
+start_item (struct worker *self, struct list *batch) {
+	struct work *w = NULL;
+
+	ASSERT (spinlock_held (&self->wq->lock));
+
+	if (!list_empty (batch)) {
+		w = list_entry (list_pop_front (batch), struct work, elem);
+		w->wq = NULL;
+	}
+	self->active_seq = w != NULL ? w->seq : INT64_MAX;
+	return w;
+}
+
+/* Returns true if every item in WQ with a seq of SEQ or less has
+   run or been canceled.  WQ's lock must be held. */
+static bool
+flush_done (struct workqueue *wq, int64_t seq) {
+	ASSERT (spinlock_held (&wq->lock));
+
+	if (!list_empty (&wq->pending)
+			&& list_entry (list_front (&wq->pending), struct work, elem)->seq
+				<= seq)
+		return false;
+	for (size_t i = 0; i < wq->worker_cnt; i++)
+		if (wq->workers[i].active_seq <= seq)
+			return false;
+	return true;
+}
+
+/* Moves the threads in workqueue_flush() whose wait is over from
+   WQ's flushers to DONE.  WQ's lock must be held.  They are woken
+   by wake_flushers() once it is released, because waking a thread
+   may switch to it. */
+static void
+finish_flushers (struct workqueue *wq, struct list *done) {
+	struct list_elem *e;
+
+	ASSERT (spinlock_held (&wq->lock));
+
+	for (e = list_begin (&wq->flushers); e != list_end (&wq->flushers); ) {
+		struct flusher *f = list_entry (e, struct flusher, elem);
+
+		e = list_next (e);
+		if (flush_done (wq, f->seq)) {
+			list_remove (&f->elem);
+			list_push_back (done, &f->elem);
+		}
+	}
+}
+
+/* Wakes the threads in DONE, which finish_flushers() filled. */
+static void
+wake_flushers (struct list *done) {
+	while (!list_empty (done))
+		sema_up (&list_entry (list_pop_front (done), struct flusher,
+					elem)->done);
+}
@@ -11,6 +11,7 @@ static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static void double_fault (struct intr_frame *);
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -46,8 +47,6 @@ exception_init (void) {
 	intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
 	intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
 	intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
-	intr_register_int (7, 0, INTR_ON, kill,
-			"#NM Device Not Available Exception");
 	intr_register_int (11, 0, INTR_ON, kill, "#NP Segment Not Present");
 	intr_register_int (12, 0, INTR_ON, kill, "#SS Stack Fault Exception");
 	intr_register_int (13, 0, INTR_ON, kill, "#GP General Protection Exception");
@@ -59,6 +58,14 @@ exception_init (void) {
 	   We need to disable interrupts for page faults because the
 	   fault address is stored in CR2 and needs to be preserved. */
 	intr_register_int (14, 0, INTR_OFF, page_fault, "#PF Page-Fault Exception");
+
+	/* A kernel stack overflow faults on the stack's guard page, and
+	   then the page fault cannot be delivered on the same stack, so
+	   it turns into a double fault.  Handle that on a stack of its
+	   own (set up by tss_init()) so that we can at least panic. */
+	intr_register_int (8, 0, INTR_OFF, double_fault,
+			"#DF Double Fault Exception");
+	intr_set_ist (8, 1);
 }
 
 /* Prints exception statistics. */
@@ -164,3 +171,11 @@ page_fault (struct intr_frame *f) {
 	exit(-1);
 }
 
+/* Double fault handler.  Runs on the IST 1 stack.  The running
+   thread cannot be found from there, so just report where the
+   stack pointer was. */
+static void
+double_fault (struct intr_frame *f) {
+	PANIC ("Double fault at rip=%p, rsp=%p: kernel stack overflow?",
+			(void *) f->rip, (void *) f->rsp);
+}
@@ -0,0 +1,161 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "userprog/process.h"
+
+/* Futex wait table.
+
+   Threads sleeping in futex_wait() are kept in a fixed table of
+   FUTEX_BUCKETS lists, hashed by futex, so a wait or wake only
+   looks at the few waiters that share its bucket.  There is no
+   per-futex object to allocate or free: a futex exists only while
+   someone is waiting on it, as the waiters themselves.
+
+   A futex is identified by its user virtual address together
+   with the address space it is in, the process's page map, which
+   stays put even if the page holding the futex is evicted and
+   comes back in a different frame.
+
+   Each bucket has a lock, held by futex_wait() from its reading
+   of the futex to its queuing itself, and by futex_wake() while
+   it takes waiters off, so no wakeup can fall between the two.
+   Reading the futex may fault the page in, so the lock is a
+   sleeping lock rather than a spinlock.
+
+   When a process begins to exit, futex_cancel_all() wakes all of
+   its waiters, and futex_wait() refuses to sleep, so that no thread
+   of the process stays asleep on a futex nobody will wake. */
+#define FUTEX_BUCKETS 64
+
+/* Identifies a futex. */
+struct futex_key {
+	const void *mm;                 /* Address space. */
+	const int *uaddr;               /* User virtual address. */
+};
+
+/* A thread in futex_wait(). */
+struct futex_waiter {
+	struct list_elem elem;          /* Element in bucket's waiters. */
+	struct futex_key key;           /* Futex waited on. */
+	struct semaphore wake;          /* Up'd by futex_wake(). */
+	bool cancelled;                 /* Woken by futex_cancel_all()? */
+};
+
+/* A list of waiters, in the order they began to wait. */
+struct futex_bucket {
+	struct lock lock;
+	struct list waiters;
+};
+
+static struct futex_bucket buckets[FUTEX_BUCKETS];
+
+static struct futex_key get_key (int *uaddr);
+static struct futex_bucket *get_bucket (const struct futex_key *);
+
+/* Initializes the futex wait table. */
+void
+futex_init (void) {
+	for (size_t i = 0; i < FUTEX_BUCKETS; i++) {
+		lock_init (&buckets[i].lock);
+		list_init (&buckets[i].waiters);
+	}
+}
+
+/* Sleeps on the futex at UADDR, a valid, aligned user address,
+   until futex_wake() wakes us, and returns 0; or returns -1 right
+   away if it does not hold VAL.  Also returns -1 if our process is
+   exiting, at once or once futex_cancel_all() wakes us. */
+int
+futex_wait (int *uaddr, int val) {
+	struct futex_waiter w;
+	struct futex_bucket *b;
+
+	w.key = get_key (uaddr);
+	b = get_bucket (&w.key);
+
+	lock_acquire (&b->lock);
+	if (process_exiting () || *(volatile int *) uaddr != val) {
+		lock_release (&b->lock);
+		return -1;
+	}
+	sema_init (&w.wake, 0);
+	w.cancelled = false;
+	list_push_back (&b->waiters, &w.elem);
+	lock_release (&b->lock);
+
+	sema_down (&w.wake);
+	return w.cancelled ? -1 : 0;
+}
+
+/* Wakes up to CNT threads sleeping on the futex at UADDR, a
+   valid, aligned user address, and returns the number woken. */
+int
+futex_wake (int *uaddr, int cnt) {
+	struct futex_key key = get_key (uaddr);
+	struct futex_bucket *b = get_bucket (&key);
+	struct list_elem *e;
+	int woken = 0;
+
+	lock_acquire (&b->lock);
+	for (e = list_begin (&b->waiters);
+			e != list_end (&b->waiters) && woken < cnt; ) {
+		struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+
+		e = list_next (e);
+		if (w->key.mm == key.mm && w->key.uaddr == key.uaddr) {
+			list_remove (&w->elem);
+			sema_up (&w->wake);
+			woken++;
+		}
+	}
+	lock_release (&b->lock);
+	return woken;
+}
+
+/* Wakes every thread of the running thread's process that sleeps
+   in futex_wait(), which returns -1 to it.  Called once the process
+   has been marked as exiting. */
+void
+futex_cancel_all (void) {
+	const void *mm = thread_current ()->pml4;
+
+	ASSERT (process_exiting ());
+
+	for (size_t i = 0; i < FUTEX_BUCKETS; i++) {
+		struct futex_bucket *b = &buckets[i];
+		struct list_elem *e;
+
+		lock_acquire (&b->lock);
+		for (e = list_begin (&b->waiters); e != list_end (&b->waiters); ) {
+			struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+
+			e = list_next (e);
+			if (w->key.mm == mm) {
+				list_remove (&w->elem);
+				w->cancelled = true;
+				sema_up (&w->wake);
+			}
+		}
+		lock_release (&b->lock);
+	}
+}
+
+/* Returns the key of the futex at UADDR in the running process. */
+static struct futex_key
+get_key (int *uaddr) {
+	struct futex_key key;
+
+	key.mm = thread_current ()->pml4;
+	key.uaddr = uaddr;
+	return key;
+}
+
+/* Returns the bucket of the futex with KEY. */
+static struct futex_bucket *
+get_bucket (const struct futex_key *key) {
+	return &buckets[hash_bytes (key, sizeof *key) % FUTEX_BUCKETS];
+}
@@ -11,12 +11,16 @@
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "threads/flags.h"
+#include "threads/fpu.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
+#include "userprog/futex.h"
+#include "userprog/syscall.h"
 #include "intrinsic.h"
 
 
@@ -24,15 +28,49 @@
 #include "vm/vm.h"
 #endif
 
+/* A new thread of a user process, being started by
+   process_thread_create(). */
+struct thread_start {
+	struct thread *creator;         /* Thread that called uthread_create(). */
+	uintptr_t rip;                  /* User entry point. */
+	uint64_t rdi, rsi;              /* Its arguments. */
+	bool success;                   /* Set by start_thread(). */
+};
+
 static void process_cleanup (void);
+static void process_destroy (struct process *);
 static bool load (const char *file_name, struct intr_frame *if_);
 static void initd (void *f_name);
 static void __do_fork (void *);
+static void start_thread (void *);
+static uint8_t *thread_stack_top (int slot);
+static bool setup_thread_stack (uint8_t *top);
 
-/* General process initializer for initd and other process. */
-static void
+/* General process initializer for initd and other process.
+   Gives the running thread a new process of its own, as its main
+   thread.  Returns false if memory is exhausted. */
+static bool
 process_init (void) {
 	struct thread *current = thread_current ();
+	struct process *p = malloc (sizeof *p);
+
+	if (p == NULL)
+		return false;
+	lock_init (&p->lock);
+	p->ref_cnt = 1;
+	list_init (&p->threads);
+	p->stack_slots = 1;
+	p->exiting = false;
+	p->exit_status = -1;
+	p->run_file = NULL;
+	lock_init (&p->fd_lock);
+#ifdef VM
+	supplemental_page_table_init (&p->spt);
+	current->spt = &p->spt;
+#endif
+	current->process = p;
+	current->stack_slot = 0;
+	return true;
 }
 
 /* Starts the first userland program, called "initd", loaded from FILE_NAME.
@@ -65,11 +103,8 @@ process_create_initd (const char *file_name) {
 /* A thread function that launches first user process. */
 static void
 initd (void *f_name) {
-#ifdef VM
-	supplemental_page_table_init (&thread_current ()->spt);
-#endif
-
-	process_init ();
+	if (!process_init ())
+		PANIC("Fail to launch initd\n");
 
 	if (process_exec (f_name) < 0)
 		PANIC("Fail to launch initd\n");
@@ -147,6 +182,10 @@ __do_fork (void *aux) {
 	/* 1. Read the cpu context to local stack. */
 	memcpy (&if_, parent_if, sizeof (struct intr_frame));
   if_.R.rax = 0;
+	fpu_copy (current, parent);
+
+	if (!process_init ())
+		goto error;
 
 	/* 2. Duplicate PT */
 	current->pml4 = pml4_create();
@@ -155,8 +194,7 @@ __do_fork (void *aux) {
 
 	process_activate (current);
 #ifdef VM
-	supplemental_page_table_init (&current->spt);
-	if (!supplemental_page_table_copy (&current->spt, &parent->spt))
+	if (!supplemental_page_table_copy (current->spt, parent->spt))
 		goto error;
 #else
 	if (!pml4_for_each (parent->pml4, duplicate_pte, parent))
@@ -169,6 +207,8 @@ __do_fork (void *aux) {
 	 * TODO:       the resources of parent.*/
   int cnt = 2;
   struct file **table = parent->fdt;
+  /* The parent's other threads may be closing files meanwhile. */
+  rwlock_read_acquire(&filesys_lock);
   while (cnt < 128) {
     if (table[cnt]) {
       current->fdt[cnt] = file_duplicate(table[cnt]);
@@ -177,10 +217,10 @@ __do_fork (void *aux) {
     }
     cnt++;
   }
+  rwlock_read_release(&filesys_lock);
 
   sema_up(&parent->fork_sema);
 
-  process_init ();
 	/* Finally, switch to the newly created process. */
 	if (succ)
 		do_iret (&if_);
@@ -204,8 +244,16 @@ process_exec (void *f_name) {
 	_if.cs = SEL_UCSEG;
 	_if.eflags = FLAG_IF | FLAG_MBS;
 
+	/* Our other threads are running in the address space we would
+	 * replace. */
+	if (thread_current ()->process->ref_cnt > 1) {
+		palloc_free_page (file_name);
+		return -1;
+	}
+
 	/* We first kill the current context */
 	process_cleanup ();
+	fpu_reset ();
 
 	/* And then load the binary */
 	success = load (file_name, &_if);
@@ -241,43 +289,283 @@ process_wait (tid_t child_tid UNUSED) {
   if (child == NULL)
     return -1;
 
-  sema_down(&child->load_sema);
+  /* If our process exits first, CHILD stays on our list, for
+     process_exit() to let go of. */
+  if (!process_sema_down(&child->load_sema))
+    return -1;
   int exit_status = child->exit_status;
   list_remove(&child->child_elem);
+  child->parent = NULL;
   sema_up(&child->exit_sema);
   return exit_status;
 }
 
-/* Exit the process. This function is called by thread_exit (). */
+/* Exit the process. This function is called by thread_exit ().
+ * Called for every thread of a process, it drops the thread's
+ * reference to the process, and the last thread out frees it. */
 void
 process_exit (void) {
   struct thread *curr = thread_current ();
-  struct file **table = curr->fdt;
+  struct process *p = curr->process;
 	/* TODO: Your code goes here.
 	 * TODO: Implement process termination message (see
 	 * TODO: project2/process_termination.html).
 	 * TODO: We recommend you to implement process resource cleanup here. */
-  //여기?
-  if (curr->run_file)
-    file_close(curr->run_file);
+  struct list_elem *e;
+  struct thread *ch;
+  bool last = true;
+  bool begun = false;
+
+  /* Nobody will wait for our children now, so let them exit. */
+  while (!list_empty (&curr->children)) {
+    e = list_pop_front (&curr->children);
+    ch = list_entry (e, struct thread, child_elem);
+    ch->parent = NULL;
+    sema_up (&ch->exit_sema);
+  }
 
-  int cnt = 2;
-  while (cnt < 128) {
-    if (table[cnt]) {
-      file_close(table[cnt]);
-      table[cnt] = NULL;
+  if (p != NULL) {
+    lock_acquire (&p->lock);
+    if (curr->stack_slot == 0) {
+      /* The process is over.  Our other threads exit on their way
+         back to user mode, and nobody will join them now. */
+      if (p->exiting)
+        curr->exit_status = p->exit_status;
+      begun = !p->exiting;
+      p->exiting = true;
+      while (!list_empty (&p->threads)) {
+        e = list_pop_front (&p->threads);
+        sema_up (&list_entry (e, struct thread, child_elem)->exit_sema);
+      }
+    } else
+      p->stack_slots &= ~(1u << curr->stack_slot);
+    last = --p->ref_cnt == 0;
+    lock_release (&p->lock);
+
+    if (begun)
+      futex_cancel_all ();
+    if (last)
+      process_destroy (p);
+    else {
+      /* As in process_cleanup(), stop using the page map before
+         letting go of it. */
+      curr->pml4 = NULL;
+      pml4_activate (NULL);
     }
-    cnt++;
   }
+  if (curr->fdt != NULL && last)
+    fdt_free (curr->fdt);
+  curr->fdt = NULL;
+
+  /* Wait to be reaped by our parent or, for a thread started by
+     uthread_create(), joined. */
+  sema_up (&curr->load_sema);
+  if (curr->parent != NULL || curr->stack_slot != 0)
+    sema_down (&curr->exit_sema);
+}
+
+/* Closes the files of P, the running thread's process, which no
+   other thread is using any longer, destroys its address space,
+   and frees it. */
+static void
+process_destroy (struct process *p) {
+  struct file **table = thread_current ()->fdt;
+
+  if (p->run_file)
+    file_close (p->run_file);
+  for (int fd = 2; fd < 128; fd++) {
+    if (table[fd]) {
+      file_close (table[fd]);
+      table[fd] = NULL;
+    }
+  }
+#ifdef VM
+  do_do_munmap ();
+#endif
+  process_cleanup ();
+  free (p);
+}
+
+/* Makes the running thread's process exit with STATUS, unless one
+   of its threads has already called exit(). */
+void
+process_terminate (int status) {
+  struct process *p = thread_current ()->process;
+  bool begun = false;
+
+  if (p == NULL)
+    return;
+  lock_acquire (&p->lock);
+  if (!p->exiting) {
+    p->exiting = true;
+    p->exit_status = status;
+    begun = true;
+  }
+  lock_release (&p->lock);
+
+  /* Get our threads out of futex_wait(). */
+  if (begun)
+    futex_cancel_all ();
+}
+
+/* Returns true if the running thread belongs to a process that is
+   exiting, in which case the thread should exit too. */
+bool
+process_exiting (void) {
+  struct process *p = thread_current ()->process;
+
+  return p != NULL && p->exiting;
+}
+
+/* Downs SEMA, as sema_down() does, unless the running thread's
+   process begins to exit first, in which case returns false
+   without downing it.  For waits that the exit itself does not
+   end, so checks every PROCESS_POLL_TICKS. */
+bool
+process_sema_down (struct semaphore *sema) {
+  if (thread_current ()->process == NULL) {
+    sema_down (sema);
+    return true;
+  }
+
+  while (!sema_down_timeout (sema, PROCESS_POLL_TICKS))
+    if (process_exiting ())
+      return false;
+  return true;
+}
+
+/* Starts a new thread in the running thread's process, which runs
+   user code at ENTRY with ARG0 and ARG1 as its first two arguments
+   on a user stack of its own.  Returns the new thread's tid, or
+   TID_ERROR if it could not be started, because the process has
+   PROCESS_THREAD_MAX threads already or memory is exhausted. */
+tid_t
+process_thread_create (uintptr_t entry, uint64_t arg0, uint64_t arg1) {
+  struct thread *cur = thread_current ();
+  struct thread_start start;
+  tid_t tid;
+
+  start.creator = cur;
+  start.rip = entry;
+  start.rdi = arg0;
+  start.rsi = arg1;
+  start.success = false;
+
+  /* START lives on our stack, so wait for the new thread to be
+     done with it. */
+  tid = thread_create (cur->name, PRI_DEFAULT, start_thread, &start);
+  if (tid == TID_ERROR)
+    return TID_ERROR;
+  sema_down (&cur->fork_sema);
+  return start.success ? tid : TID_ERROR;
+}
+
+/* A thread function that enters user mode in a new thread of the
+   creator's process, as set up by process_thread_create(). */
+static void
+start_thread (void *start_) {
+  struct thread_start *start = start_;
+  struct thread *creator = start->creator;
+  struct thread *curr = thread_current ();
+  struct process *p = creator->process;
+  struct intr_frame if_;
+  int slot;
+
+  /* We are a thread of the creator's process, not its child. */
+  list_remove (&curr->child_elem);
+  curr->parent = NULL;
+
+  fdt_free (curr->fdt);
+  curr->fdt = creator->fdt;
+  curr->pml4 = creator->pml4;
+#ifdef VM
+  curr->spt = creator->spt;
+#endif
+  process_activate (curr);
+
+  lock_acquire (&p->lock);
+  for (slot = 1; slot < PROCESS_THREAD_MAX; slot++)
+    if ((p->stack_slots & (1u << slot)) == 0)
+      break;
+  if (!p->exiting && slot < PROCESS_THREAD_MAX
+      && setup_thread_stack (thread_stack_top (slot))) {
+    p->stack_slots |= 1u << slot;
+    p->ref_cnt++;
+    list_push_back (&p->threads, &curr->child_elem);
+    curr->process = p;
+    curr->stack_slot = slot;
+    curr->exit_status = -1;
+    start->success = true;
+  }
+  lock_release (&p->lock);
+
+  if (!start->success) {
+    curr->fdt = NULL;
+    curr->pml4 = NULL;
+    pml4_activate (NULL);
+    sema_up (&creator->fork_sema);
+    thread_exit ();
+  }
+
+  memset (&if_, 0, sizeof if_);
+  if_.ds = if_.es = if_.ss = SEL_UDSEG;
+  if_.cs = SEL_UCSEG;
+  if_.eflags = FLAG_IF | FLAG_MBS;
+  if_.rip = start->rip;
+  if_.R.rdi = start->rdi;
+  if_.R.rsi = start->rsi;
+  /* Leave room for a fake return address, as a call would. */
+  if_.rsp = (uintptr_t) thread_stack_top (curr->stack_slot) - sizeof (void *);
+
+  sema_up (&creator->fork_sema);
+  do_iret (&if_);
+  NOT_REACHED ();
+}
+
+/* Waits for thread TID of the running thread's process, which must
+   have been started by uthread_create(), to exit, and returns the
+   status it gave to uthread_exit(), or -1 if it was killed.
+   Returns -1 immediately if TID is not such a thread, is the
+   running thread, or has already been joined. */
+int
+process_thread_join (tid_t tid) {
+  struct process *p = thread_current ()->process;
+  struct thread *t = NULL;
   struct list_elem *e;
-  struct thread *ch;
+  int status;
 
-  sema_up(&curr->load_sema);
-  do_do_munmap();
-  sema_down(&curr->exit_sema);
+  if (tid == thread_tid ())
+    return -1;
+
+  /* Once off the list, T is ours alone to join. */
+  lock_acquire (&p->lock);
+  for (e = list_begin (&p->threads); e != list_end (&p->threads);
+       e = list_next (e))
+    if (list_entry (e, struct thread, child_elem)->tid == tid) {
+      t = list_entry (e, struct thread, child_elem);
+      list_remove (e);
+      break;
+    }
+  lock_release (&p->lock);
+  if (t == NULL)
+    return -1;
 
-  palloc_free_page(table);
-  process_cleanup();
+  /* If our process exits first, T exits too; let it go unjoined. */
+  status = process_sema_down (&t->load_sema) ? t->exit_status : -1;
+  sema_up (&t->exit_sema);
+  return status;
+}
+
+/* Returns the top of the user stack in SLOT, for a thread started
+   by uthread_create().  The stacks lie below the 1 MB the main
+   thread's stack may grow to, each with an unmapped guard page
+   above it. */
+static uint8_t *
+thread_stack_top (int slot) {
+  ASSERT (slot > 0 && slot < PROCESS_THREAD_MAX);
+
+  return (uint8_t *) USER_STACK - (1 << 20)
+         - (slot - 1) * (THREAD_STACK_PAGES + 1) * PGSIZE - PGSIZE;
 }
 
 /* Free the current process's resources. */
@@ -286,7 +574,7 @@ process_cleanup (void) {
 	struct thread *curr = thread_current ();
 
 #ifdef VM
-	supplemental_page_table_kill (&curr->spt);
+	supplemental_page_table_kill (curr->spt);
 #endif
 
 	uint64_t *pml4;
@@ -493,7 +781,7 @@ load (const char *file_name, struct intr_frame *if_) {
 	success = true;
 
   // * 추가
-  t->run_file = file;
+  t->process->run_file = file;
   file_deny_write(file);
 
 done:
@@ -502,18 +790,9 @@ done:
 }
 
 struct thread *get_child_process(int pid) {
-  struct thread *cur = thread_current();
-  struct list *child_list = &cur->children;
-  struct list_elem *cur_child = list_begin(child_list);
-
-  while (cur_child != list_end(child_list)) {
-    struct thread *cur_t = list_entry(cur_child, struct thread, child_elem);
-    if (cur_t->tid == pid) {
-      return cur_t;
-    }
-    cur_child = list_next(cur_child);
-  }
-  return NULL;
+  /* A child cannot exit until we wait for it, and once we have,
+     its parent is cleared. */
+  return thread_lookup_child (pid);
 }
 
 void argument_stack(char **parse, int count, void **esp) {
@@ -681,6 +960,30 @@ setup_stack (struct intr_frame *if_) {
 	return success;
 }
 
+/* Maps zeroed pages for the THREAD_STACK_PAGES of user stack
+   below TOP, except any that are mapped already. */
+static bool
+setup_thread_stack (uint8_t *top) {
+	struct thread *t = thread_current ();
+	uint8_t *upage;
+
+	for (upage = top - THREAD_STACK_PAGES * PGSIZE; upage < top;
+			upage += PGSIZE) {
+		uint8_t *kpage;
+
+		if (pml4_get_page (t->pml4, upage) != NULL)
+			continue;
+		kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+		if (kpage == NULL)
+			return false;
+		if (!install_page (upage, kpage, true)) {
+			palloc_free_page (kpage);
+			return false;
+		}
+	}
+	return true;
+}
+
 /* Adds a mapping from user virtual address UPAGE to kernel
  * virtual address KPAGE to the page table.
  * If WRITABLE is true, the user process may modify the page;
@@ -804,4 +1107,20 @@ setup_stack (struct intr_frame *if_) {
 	}
 	return success;
 }
+
+/* Adds anonymous pages for the THREAD_STACK_PAGES of user stack
+   below TOP, except any that are there already.  They are claimed
+   lazily, when first touched. */
+static bool
+setup_thread_stack (uint8_t *top) {
+	struct supplemental_page_table *spt = thread_current ()->spt;
+	uint8_t *upage;
+
+	for (upage = top - THREAD_STACK_PAGES * PGSIZE; upage < top;
+			upage += PGSIZE)
+		if (spt_find_page (spt, upage) == NULL
+				&& !vm_alloc_page (VM_ANON | VM_MARKER_0, upage, true))
+			return false;
+	return true;
+}
 #endif /* VM */
\ No newline at end of file
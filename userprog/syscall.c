@@ -1,12 +1,20 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/loader.h"
+#include "threads/malloc.h"
 #include "userprog/gdt.h"
 #include "threads/flags.h"
+#include "devices/input.h"
+#include "devices/timer.h"
+#include "userprog/futex.h"
+#include "userprog/process.h"
 #include "intrinsic.h"
+#include <futex.h>
+#include <clock.h>
 
 // * USERPROG 추가
 #include "threads/palloc.h"
@@ -14,6 +22,8 @@
 #include "filesys/file.h"
 #include "include/vm/vm.h"
 
+struct rwlock filesys_lock;
+
 void syscall_entry (void);
 void syscall_handler (struct intr_frame *);
 
@@ -33,7 +43,9 @@ void syscall_handler (struct intr_frame *);
 void
 syscall_init (void) {
 
-  lock_init(&filesys_lock);
+  rwlock_init(&filesys_lock);
+  rwlock_set_name (&filesys_lock, "filesys");
+  futex_init ();
 
 	write_msr(MSR_STAR, ((uint64_t)SEL_UCSEG - 0x10) << 48  |
 			((uint64_t)SEL_KCSEG) << 32);
@@ -50,6 +62,10 @@ syscall_init (void) {
 void
 syscall_handler (struct intr_frame *f UNUSED) {
 	// TODO: Your implementation goes here.
+  /* Another thread has called exit(), ending our process. */
+  if (process_exiting ())
+    thread_exit ();
+
   switch (f->R.rax) {
     case SYS_HALT:
       halt();
@@ -100,10 +116,36 @@ syscall_handler (struct intr_frame *f UNUSED) {
     case SYS_MUNMAP:
       munmap(f->R.rdi);
       break;
+    case SYS_SCHEDSTAT:
+      f->R.rax = (uint64_t)schedstat(f->R.rdi, (struct sched_stats *)f->R.rsi);
+      break;
+    case SYS_FUTEX:
+      f->R.rax = (uint64_t)futex((int *)f->R.rdi, f->R.rsi, f->R.rdx);
+      break;
+    case SYS_LOCKSTAT:
+      f->R.rax = (uint64_t)lockstat((struct lockstat *)f->R.rdi, f->R.rsi);
+      break;
+    case SYS_UTHREAD_CREATE:
+      f->R.rax = (uint64_t)uthread_create((void *)f->R.rdi, (void *)f->R.rsi,
+                                               (void *)f->R.rdx);
+      break;
+    case SYS_UTHREAD_EXIT:
+      uthread_exit(f->R.rdi);
+      break;
+    case SYS_UTHREAD_JOIN:
+      f->R.rax = (uint64_t)uthread_join(f->R.rdi);
+      break;
+    case SYS_CLOCK_GETTIME:
+      f->R.rax = (uint64_t)clock_gettime(f->R.rdi, (struct timespec *)f->R.rsi);
+      break;
     default:
       exit(-1);
       break;
   }
+
+  /* Or did so while we were in the kernel. */
+  if (process_exiting ())
+    thread_exit ();
 }
 
 void halt(void) {
@@ -121,6 +163,7 @@ void exit(int status) {
   struct thread *cur = thread_current();
   cur->exit_status = status;
   printf("%s: exit(%d)\n", cur->name, status);
+  process_terminate(status);
   thread_exit();
 }
 
@@ -167,28 +210,47 @@ bool remove (const char *file) {
   return filesys_remove(file);
 }
 
+/* Returns the file open as FD in the running thread's fd table,
+   or a null pointer if there is none.  The caller must hold
+   filesys_lock, in either mode, for as long as it uses the file,
+   so that a sibling thread cannot close it meanwhile. */
+static struct file *fd_lookup (int fd) {
+  if (fd < 2 || fd >= 128)
+    return NULL;
+  return thread_current ()->fdt[fd];
+}
+
 int open (const char *file) {
   check_address(file);
   struct thread *cur = thread_current();
+  struct process *p = cur->process;
   struct file *fd = filesys_open(file);
   if (fd) {
+    /* Our sibling threads may be claiming slots too. */
+    lock_acquire (&p->fd_lock);
     for (int i = 2; i < 128; i++) {
       if (!cur->fdt[i]) {
         cur->fdt[i] = fd;
         cur->next_fd = i + 1;
+        lock_release (&p->fd_lock);
         return i;
       }
     }
+    lock_release (&p->fd_lock);
     file_close(fd);
   }
   return -1;
 }
 
 int filesize (int fd) {
-  struct file *file = thread_current()->fdt[fd];
+  int length = -1;
+
+  rwlock_read_acquire(&filesys_lock);
+  struct file *file = fd_lookup(fd);
   if (file)
-    return file_length(file);
-  return -1;
+    length = file_length(file);
+  rwlock_read_release(&filesys_lock);
+  return length;
 }
 
 int read (int fd, void *buffer, unsigned size) {
@@ -199,19 +261,23 @@ int read (int fd, void *buffer, unsigned size) {
   }
 
   if (fd == 0) {
-    lock_acquire(&filesys_lock);
-    int byte = input_getc();
-    lock_release(&filesys_lock);
-    return byte;
-  }
-  struct file *file = thread_current()->fdt[fd];
-  if (file) {
-    lock_acquire(&filesys_lock);
-    int read_byte = file_read(file, buffer, size);
-    lock_release(&filesys_lock);
-    return read_byte;
+    /* Don't sleep in input_getc(), which would not notice our
+       process exiting. */
+    uint8_t key;
+    while (!input_try_getc(&key)) {
+      if (process_exiting())
+        return -1;
+      timer_sleep(PROCESS_POLL_TICKS);
+    }
+    return key;
   }
-  return -1;
+  int read_byte = -1;
+  rwlock_read_acquire(&filesys_lock);
+  struct file *file = fd_lookup(fd);
+  if (file)
+    read_byte = file_read(file, buffer, size);
+  rwlock_read_release(&filesys_lock);
+  return read_byte;
 }
 
 int write (int fd UNUSED, const void *buffer, unsigned size) {
@@ -222,41 +288,54 @@ int write (int fd UNUSED, const void *buffer, unsigned size) {
     return -1;
 
   if (fd == 1) {
-    lock_acquire(&filesys_lock);
+    rwlock_write_acquire(&filesys_lock);
 	  putbuf(buffer, size);
-    lock_release(&filesys_lock);
+    rwlock_write_release(&filesys_lock);
     return size;
   }
 
-  struct file *file = thread_current()->fdt[fd];
-  if (file) {
-    lock_acquire(&filesys_lock);
-    int write_byte = file_write(file, buffer, size);
-    lock_release(&filesys_lock);
-    return write_byte;
-  }
+  int write_byte = -1;
+  rwlock_write_acquire(&filesys_lock);
+  struct file *file = fd_lookup(fd);
+  if (file)
+    write_byte = file_write(file, buffer, size);
+  rwlock_write_release(&filesys_lock);
+  return write_byte;
 }
 
 void seek (int fd, unsigned position) {
-  struct file *curfile = thread_current()->fdt[fd];
+  rwlock_read_acquire(&filesys_lock);
+  struct file *curfile = fd_lookup(fd);
   if (curfile)
     file_seek(curfile, position);
+  rwlock_read_release(&filesys_lock);
 }
 
 unsigned tell (int fd) {
-  struct file *curfile = thread_current()->fdt[fd];
+  unsigned pos = -1;
+
+  rwlock_read_acquire(&filesys_lock);
+  struct file *curfile = fd_lookup(fd);
   if (curfile)
-    return file_tell(curfile);
+    pos = file_tell(curfile);
+  rwlock_read_release(&filesys_lock);
+  return pos;
 }
 
 void close (int fd) {
-  struct file * file = thread_current()->fdt[fd];
-  if (file) {
-    lock_acquire(&filesys_lock);
+  struct process *p = thread_current()->process;
+
+  /* Clearing the slot with filesys_lock held for writing waits out
+     any sibling thread still using the file. */
+  rwlock_write_acquire(&filesys_lock);
+  lock_acquire(&p->fd_lock);
+  struct file *file = fd_lookup(fd);
+  if (file)
     thread_current()->fdt[fd] = NULL;
+  lock_release(&p->fd_lock);
+  if (file)
     file_close(file);
-    lock_release(&filesys_lock);
-  }
+  rwlock_write_release(&filesys_lock);
 }
 
 /* pintos project2 add
@@ -265,7 +344,7 @@ void check_address(void *addr)
 {
   struct thread *cur = thread_current();
 #ifdef VM
-  if (addr == NULL || is_kernel_vaddr(addr) || spt_find_page(&cur->spt, addr) == NULL)
+  if (addr == NULL || is_kernel_vaddr(addr) || spt_find_page(cur->spt, addr) == NULL)
     exit(-1);
 #else
   if (addr == NULL || is_kernel_vaddr(addr) || pml4_get_page(cur->pml4, addr) == NULL)
@@ -280,7 +359,7 @@ void check_valid_string (const void *str, unsigned size) {
 
   for (int i = 0; i < size; i += PGSIZE)
   {
-    struct page *p = spt_find_page(&cur->spt, str + i);
+    struct page *p = spt_find_page(cur->spt, str + i);
     if (p == NULL)
     {
       // printf("check valid buffer writable %d, p->writable %d\n", writable, p->writable);
@@ -297,7 +376,7 @@ void check_valid_buffer (void *buffer, unsigned size, bool to_write) {
 
   for (int i = 0; i < size; i += PGSIZE)
   {
-    struct page *p = spt_find_page(&cur->spt, buffer + i);
+    struct page *p = spt_find_page(cur->spt, buffer + i);
     if (!p->writable)
     {
       // printf("check valid buffer writable %d, p->writable %d\n", writable, p->writable);
@@ -317,7 +396,12 @@ void *mmap (void *addr, size_t length, int writable, int fd, off_t offset) {
     return NULL;
   }
 
-  struct file* file = file_reopen(thread_current()->fdt[fd]);
+  rwlock_read_acquire(&filesys_lock);
+  struct file *open_file = fd_lookup(fd);
+  struct file *file = open_file != NULL ? file_reopen(open_file) : NULL;
+  rwlock_read_release(&filesys_lock);
+  if (file == NULL)
+    return NULL;
   return do_mmap(addr, length, writable, file, offset);
 }
 
@@ -329,4 +413,106 @@ void munmap (void *addr) {
   do_munmap(addr);
 }
 
+/* Copies the scheduling statistics of process PID into STATS.
+   PID may be 0 for the caller itself, one of the caller's
+   children, or SCHEDSTAT_ALL for system-wide totals.  Returns
+   false if PID is none of those. */
+bool schedstat (int pid, struct sched_stats *stats) {
+  struct sched_stats buf;
+  struct thread *t;
+
+  check_valid_buffer (stats, sizeof *stats, true);
+  if (pid == SCHEDSTAT_ALL)
+    t = NULL;
+  else if (pid == 0 || pid == thread_tid ())
+    t = thread_current ();
+  else if ((t = get_child_process (pid)) == NULL)
+    return false;
+
+  thread_sched_stats (t, &buf);
+  memcpy (stats, &buf, sizeof buf);
+  return true;
+}
+
+/* Waits on or wakes the futex at UADDR, as OP says; see
+   lib/futex.h.  Returns -1 if UADDR is misaligned or OP is not a
+   futex operation. */
+int futex (int *uaddr, int op, int val) {
+  check_address (uaddr);
+  if ((uintptr_t) uaddr % sizeof *uaddr != 0)
+    return -1;
+
+  switch (op) {
+    case FUTEX_WAIT:
+      return futex_wait (uaddr, val);
+    case FUTEX_WAKE:
+      return futex_wake (uaddr, val);
+    default:
+      return -1;
+  }
+}
+
+/* Copies the statistics of up to CNT of the most waited-for kernel
+   locks into STATS, most waited for first, and returns the number
+   copied.  Returns -1 if CNT is negative. */
+int lockstat (struct lockstat *stats, int cnt) {
+  struct lockstat *buf;
+
+  if (cnt < 0)
+    return -1;
+  if (cnt > LOCKSTAT_MAX)
+    cnt = LOCKSTAT_MAX;
+  if (cnt == 0)
+    return 0;
+  check_valid_buffer (stats, cnt * sizeof *stats, true);
+
+  /* Too big for the kernel stack, and the locks' statistics may
+     not be copied straight to user memory, which could fault. */
+  buf = malloc (cnt * sizeof *buf);
+  if (buf == NULL)
+    return -1;
+  cnt = lock_stats_top (buf, cnt);
+  memcpy (stats, buf, cnt * sizeof *buf);
+  free (buf);
+  return cnt;
+}
 
+/* Stores the current time of CLOCK into *TS.  Returns 0 if
+   successful, -1 if CLOCK is not a known clock. */
+int clock_gettime (int clock, struct timespec *ts) {
+  struct timespec now;
+  int64_t ns;
+
+  check_valid_buffer (ts, sizeof *ts, true);
+  if (clock != CLOCK_MONOTONIC)
+    return -1;
+
+  ns = timer_ns ();
+  now.tv_sec = ns / NSEC_PER_SEC;
+  now.tv_nsec = ns % NSEC_PER_SEC;
+  memcpy (ts, &now, sizeof now);
+  return 0;
+}
+
+/* Starts a thread in this process that runs FUNC (AUX) by way of
+   the user library's ENTRY, and returns its tid, or -1. */
+tid_t uthread_create (void *entry, void *func, void *aux) {
+  check_address (entry);
+  return process_thread_create ((uintptr_t) entry, (uint64_t) func,
+                                (uint64_t) aux);
+}
+
+/* Ends this thread, giving STATUS to uthread_join().  In the main
+   thread, ends the whole process, as exit() does. */
+void uthread_exit (int status) {
+  struct thread *cur = thread_current ();
+
+  if (cur->stack_slot == 0)
+    exit (status);
+  cur->exit_status = status;
+  thread_exit ();
+}
+
+int uthread_join (tid_t tid) {
+  return process_thread_join (tid);
+}
@@ -3,6 +3,7 @@
 #include <stddef.h>
 #include "userprog/gdt.h"
 #include "threads/thread.h"
+#include "threads/kstack.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
 #include "intrinsic.h"
@@ -56,6 +57,10 @@ tss_init (void) {
 	 * ones we initialize. */
 	tss = palloc_get_page (PAL_ASSERT | PAL_ZERO);
 	tss_update (thread_current ());
+
+	/* Stack for double faults (see exception.c), which most likely
+	   mean the current kernel stack is unusable. */
+	tss->ist1 = (uint64_t) palloc_get_page (PAL_ASSERT) + PGSIZE;
 }
 
 /* Returns the kernel TSS. */
@@ -70,5 +75,5 @@ tss_get (void) {
 void
 tss_update (struct thread *next) {
 	ASSERT (tss != NULL);
-	tss->rsp0 = (uint64_t) next + PGSIZE;
+	tss->rsp0 = (uint64_t) next + KSTACK_SIZE;
 }
@@ -175,24 +175,24 @@ void munmap_page (struct hash_elem *e, void *aux){
 				file_write_at(page->file.file, addr, page->file.read_byte, page->file.offset);
 			}	
 			addr += PGSIZE;
-			page = spt_find_page(&thread_current()->spt, addr);
+			page = spt_find_page(thread_current()->spt, addr);
 		}
 	}
 }
 
 void do_do_munmap() {
-	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct supplemental_page_table *spt = thread_current()->spt;
 	hash_clear(&spt->hash, munmap_page);
 }
 
 void
 do_munmap (void *addr) {
-	struct page *page = spt_find_page(&thread_current()->spt, pg_round_down(addr));
+	struct page *page = spt_find_page(thread_current()->spt, pg_round_down(addr));
 
 	struct file *file = page->file.file;
 	off_t read_size = file_length(file);
 
-	while (page = spt_find_page(&thread_current()->spt, addr)){
+	while (page = spt_find_page(thread_current()->spt, addr)){
 		if (page->file.file != file) {
 			return;
 		} 
@@ -67,7 +67,7 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 	ASSERT (VM_TYPE(type) != VM_UNINIT)
 
     bool success = false;
-	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct supplemental_page_table *spt = thread_current()->spt;
 
     /* Check wheter the upage is already occupied or not. */
     if (spt_find_page(spt, upage) == NULL)
@@ -102,7 +102,9 @@ spt_find_page (struct supplemental_page_table *spt UNUSED, void *va UNUSED) {
 	/* pintos project3 */
 	struct page page;
 	page.va = pg_round_down(va);
+	rwlock_read_acquire(&spt->lock);
 	struct hash_elem *found_elem = hash_find(&spt->hash, &(page.elem));
+	rwlock_read_release(&spt->lock);
 
 	if (!found_elem){
 		return NULL;
@@ -119,9 +121,11 @@ spt_insert_page (struct supplemental_page_table *spt UNUSED,
 	/* pintos project3 */
     int success = false;
 	/* TODO: Fillthis function. */
+	rwlock_write_acquire(&spt->lock);
 	if(hash_insert (&(spt->hash), &(page->elem)) == NULL){
 		success = true;
 	}
+	rwlock_write_release(&spt->lock);
 	return success;
 }
 
@@ -139,7 +143,7 @@ vm_get_victim (void) {
 
 	/* pintos project3 */
 	struct thread * curr = thread_current();
-	struct hash hash = curr->spt.hash;
+	struct hash hash = curr->spt->hash;
 	struct hash_iterator *iter;
 	hash_first(iter,&hash);
 	while(hash_next(iter)) {
@@ -226,7 +230,7 @@ vm_handle_wp (struct page *page UNUSED) {
 bool
 vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,
         bool user UNUSED, bool write UNUSED, bool not_present UNUSED) {
-    struct supplemental_page_table *spt UNUSED = &thread_current ()->spt;
+    struct supplemental_page_table *spt UNUSED = thread_current ()->spt;
     
     /* pintos project3 */
     struct page *page = spt_find_page(spt, addr);
@@ -278,7 +282,7 @@ vm_dealloc_page (struct page *page) {
  * 먼저 페이지를 가져온 다음 해당 페이지와 함께 vm_do_claim_page를 호출해야 합니다. */
 bool
 vm_claim_page (void *va UNUSED) {
-	struct page *page = spt_find_page(&thread_current()->spt, va);
+	struct page *page = spt_find_page(thread_current()->spt, va);
 	/* TODO: Fill this function */
 	/* pintos project3 */
 
@@ -318,6 +322,7 @@ void
 supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
 	/* pintos project3 */
 	hash_init(&spt->hash, vm_hash_func, vm_less_func, NULL);
+	rwlock_init(&spt->lock);
 }
 
 /* pintos project3 */
@@ -327,7 +332,7 @@ void copy_page (struct hash_elem *e, void *aux)
 
 	vm_alloc_page(page->uninit.type , page->va , page->writable);
 	if(page->frame){
-		struct page *child = spt_find_page(&thread_current()->spt ,page->va);
+		struct page *child = spt_find_page(thread_current()->spt ,page->va);
 		child->frame = vm_get_frame();
 		memcpy(child->frame->kva, page->frame->kva, PGSIZE);
 		child->frame->page = child;
@@ -346,7 +351,9 @@ supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
 
 	/* src 테이블에서 모든 page 구조체를 dst 테이블로 복사*/
 	/* 타입이 uninit, anon, file 얘네를 다 uninit으로 할당 */
+	rwlock_read_acquire(&src->lock);
 	hash_apply(&src->hash, copy_page);
+	rwlock_read_release(&src->lock);
 	return true;
 }
 